@@ -122,6 +122,41 @@ public class CommandLineOptions
     )]
     public DirectoryInfo? DevPrimitiveCacheFolder { get; init; } = null;
 
+    [Option(
+        longName: "FbxGeometryTemplateLibraryFile",
+        Required = false,
+        HelpText = "The path to a file with the instanced geometry templates of FBX parts. It is read before the FBX "
+            + "files are parsed and written after, so later runs can reuse the templates. Templates unused for 10 "
+            + "runs are dropped. If not set the templates are only shared within this run."
+    )]
+    public FileInfo? FbxGeometryTemplateLibraryFile { get; init; } = null;
+
+    [
+        Option(
+            longName: "FbxVertexWeldTolerance",
+            Default = 0.0f,
+            Required = false,
+            HelpText = "Welds FBX mesh vertices closer than this to each other, and removes the degenerate and "
+                + "duplicate triangles this leaves. In the units the meshes are stored in, not meters. "
+                + "0 disables welding."
+        ),
+        Range(0, float.MaxValue)
+    ]
+    public float FbxVertexWeldTolerance { get; set; }
+
+    [
+        Option(
+            longName: "FbxOutlierDistanceFactor",
+            Default = 2.0f,
+            Required = false,
+            HelpText = "FBX parts further away from the bulk of the model than this many times its size are "
+                + "removed as trash left behind in the model. Only applies to files without attributes. "
+                + "0 disables the removal."
+        ),
+        Range(0, float.MaxValue)
+    ]
+    public float FbxOutlierDistanceFactor { get; set; }
+
     public static void AssertValidOptions(CommandLineOptions options)
     {
         // Validate DataAttributes
@@ -148,5 +183,11 @@ public class CommandLineOptions
                     + options.DevPrimitiveCacheFolder.FullName
             );
         }
+
+        if (options.FbxGeometryTemplateLibraryFile?.Directory is { Exists: false } libraryDirectory)
+        {
+            // Creates the whole path, the file itself is written after the FBX files are parsed
+            Directory.CreateDirectory(libraryDirectory.FullName);
+        }
     }
 }
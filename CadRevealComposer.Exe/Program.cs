@@ -75,7 +75,16 @@ public static class Program
             throw new ArgumentException("SplitIntoZones is no longer supported. Use regular Octree splitting instead.");
         }
 
-        var providers = new List<IModelFormatProvider>() { new ObjProvider(), new RvmProvider(), new FbxProvider() };
+        var providers = new List<IModelFormatProvider>()
+        {
+            new ObjProvider(),
+            new RvmProvider(),
+            new FbxProvider(
+                options.FbxGeometryTemplateLibraryFile,
+                options.FbxVertexWeldTolerance,
+                options.FbxOutlierDistanceFactor
+            ),
+        };
 
         using (new TeamCityLogBlock("Parameters"))
         {
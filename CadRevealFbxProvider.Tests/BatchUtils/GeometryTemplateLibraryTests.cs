@@ -0,0 +1,167 @@
+namespace CadRevealFbxProvider.Tests.BatchUtils;
+
+using System.Numerics;
+using CadRevealComposer.IdProviders;
+using CadRevealComposer.Tessellation;
+using CadRevealFbxProvider.BatchUtils;
+
+[TestFixture]
+public class GeometryTemplateLibraryTests
+{
+    private static readonly FbxMeshWrapper.MeshCounts TriangleCounts = new(3, 1, 3);
+
+    private DirectoryInfo _directory = null!;
+
+    [SetUp]
+    public void SetUp()
+    {
+        _directory = Directory.CreateTempSubdirectory();
+    }
+
+    [TearDown]
+    public void TearDown()
+    {
+        _directory.Delete(recursive: true);
+    }
+
+    private static Mesh CreateTriangle(float size)
+    {
+        return new Mesh([Vector3.Zero, new Vector3(size, 0, 0), new Vector3(0, size, 0)], [0, 1, 2], 0f);
+    }
+
+    private FileInfo LibraryFile => new(Path.Combine(_directory.FullName, "library.gtl"));
+
+    [Test]
+    public void TryGetTemplate_InstancedTemplate_ReturnsSameMeshAndInstanceId()
+    {
+        var library = new GeometryTemplateLibrary();
+        var instanceIdGenerator = new InstanceIdGenerator();
+        var mesh = CreateTriangle(1);
+        var instanceId = instanceIdGenerator.GetNextId();
+
+        Assert.That(library.TryGetTemplate(42, TriangleCounts, instanceIdGenerator, out _), Is.False);
+        library.Add(42, TriangleCounts, mesh, instanceId);
+
+        Assert.That(library.TryGetTemplate(42, TriangleCounts, instanceIdGenerator, out var template), Is.True);
+        Assert.That(template.templateMesh, Is.SameAs(mesh));
+        Assert.That(template.instanceId, Is.EqualTo(instanceId));
+        Assert.That(library.Hits, Is.EqualTo(1));
+        Assert.That(library.Misses, Is.EqualTo(1));
+    }
+
+    [Test]
+    public void TryGetTemplate_SameHashOtherCounts_IsAMiss()
+    {
+        var library = new GeometryTemplateLibrary();
+        var instanceIdGenerator = new InstanceIdGenerator();
+        library.Add(42, TriangleCounts, CreateTriangle(1), instanceIdGenerator.GetNextId());
+
+        var quadCounts = new FbxMeshWrapper.MeshCounts(4, 1, 4);
+        Assert.That(library.TryGetTemplate(42, quadCounts, instanceIdGenerator, out _), Is.False);
+        Assert.That(library.Collisions, Is.EqualTo(1));
+        Assert.That(library.Misses, Is.EqualTo(1));
+
+        // The colliding geometry replaces the template
+        var quad = new Mesh([Vector3.Zero, Vector3.UnitX, Vector3.One, Vector3.UnitY], [0, 1, 2, 0, 2, 3], 0f);
+        library.Add(42, quadCounts, quad, instanceIdGenerator.GetNextId());
+        Assert.That(library.TryGetTemplate(42, quadCounts, instanceIdGenerator, out var template), Is.True);
+        Assert.That(template.templateMesh, Is.SameAs(quad));
+        Assert.That(library.Count, Is.EqualTo(1));
+    }
+
+    [Test]
+    public void WriteToFile_ReadFromFile_TemplatesAreRestoredAndGetInstanceIdOnce()
+    {
+        var library = new GeometryTemplateLibrary();
+        var instanceIdGenerator = new InstanceIdGenerator();
+        var mesh1 = CreateTriangle(1);
+        var mesh2 = CreateTriangle(2);
+        library.Add(1, TriangleCounts, mesh1, instanceIdGenerator.GetNextId());
+        library.Add(2, TriangleCounts, mesh2, instanceIdGenerator.GetNextId());
+
+        Assert.That(library.WriteToFile(LibraryFile), Is.EqualTo(2));
+        var restored = GeometryTemplateLibrary.ReadFromFile(LibraryFile);
+
+        Assert.That(_directory.GetFiles().Select(x => x.Name), Is.EqualTo(new[] { LibraryFile.Name }));
+        Assert.That(restored.Count, Is.EqualTo(2));
+        Assert.That(restored.TryGetTemplate(1, TriangleCounts, instanceIdGenerator, out var template1), Is.True);
+        Assert.That(restored.TryGetTemplate(2, TriangleCounts, instanceIdGenerator, out var template2), Is.True);
+        Assert.That(restored.TryGetTemplate(2, TriangleCounts, instanceIdGenerator, out var template2Again), Is.True);
+        Assert.That(template1.templateMesh, Is.EqualTo(mesh1));
+        Assert.That(template2.templateMesh, Is.EqualTo(mesh2));
+        Assert.That(template2Again.instanceId, Is.EqualTo(template2.instanceId));
+        Assert.That(template2Again.templateMesh, Is.SameAs(template2.templateMesh));
+        Assert.That(restored.PersistedHits, Is.EqualTo(3));
+        Assert.That(restored.TryGetTemplate(1, new(4, 1, 4), instanceIdGenerator, out _), Is.False);
+    }
+
+    [Test]
+    public void WriteToFile_TemplateNotUsedForMaxRuns_IsDropped()
+    {
+        var instanceIdGenerator = new InstanceIdGenerator();
+        var library = new GeometryTemplateLibrary();
+        library.Add(1, TriangleCounts, CreateTriangle(1), instanceIdGenerator.GetNextId());
+        library.Add(2, TriangleCounts, CreateTriangle(2), instanceIdGenerator.GetNextId());
+        library.WriteToFile(LibraryFile);
+
+        // Only template 2 is used in the following runs
+        for (var run = 1; run < GeometryTemplateLibrary.MaxRunsWithoutUse; run++)
+        {
+            library = GeometryTemplateLibrary.ReadFromFile(LibraryFile);
+            library.TryGetTemplate(2, TriangleCounts, instanceIdGenerator, out _);
+            Assert.That(library.WriteToFile(LibraryFile), Is.EqualTo(2));
+        }
+
+        library = GeometryTemplateLibrary.ReadFromFile(LibraryFile);
+        library.TryGetTemplate(2, TriangleCounts, instanceIdGenerator, out _);
+        Assert.That(library.WriteToFile(LibraryFile), Is.EqualTo(1));
+
+        var restored = GeometryTemplateLibrary.ReadFromFile(LibraryFile);
+        Assert.That(restored.TryGetTemplate(1, TriangleCounts, instanceIdGenerator, out _), Is.False);
+        Assert.That(restored.TryGetTemplate(2, TriangleCounts, instanceIdGenerator, out _), Is.True);
+    }
+
+    [Test]
+    public void ReadFromFile_OtherWeldTolerance_ReturnsEmptyLibrary()
+    {
+        var library = new GeometryTemplateLibrary(weldTolerance: 0.001f);
+        library.Add(1, TriangleCounts, CreateTriangle(1), new InstanceIdGenerator().GetNextId());
+        library.WriteToFile(LibraryFile);
+
+        var otherTolerance = GeometryTemplateLibrary.ReadFromFile(LibraryFile);
+        Assert.That(otherTolerance.Count, Is.EqualTo(0));
+        Assert.That(otherTolerance.WeldTolerance, Is.EqualTo(0f));
+
+        var restored = GeometryTemplateLibrary.ReadFromFile(LibraryFile, weldTolerance: 0.001f);
+        Assert.That(restored.Count, Is.EqualTo(1));
+        Assert.That(restored.WeldTolerance, Is.EqualTo(0.001f));
+    }
+
+    [Test]
+    public void ReadFromFile_TruncatedFile_ReturnsEmptyLibrary()
+    {
+        var library = new GeometryTemplateLibrary();
+        library.Add(1, TriangleCounts, CreateTriangle(1), new InstanceIdGenerator().GetNextId());
+        library.WriteToFile(LibraryFile);
+
+        using (var stream = LibraryFile.OpenWrite())
+        {
+            stream.SetLength(stream.Length - 6);
+        }
+
+        var restored = GeometryTemplateLibrary.ReadFromFile(LibraryFile);
+        Assert.That(restored.Count, Is.EqualTo(0));
+
+        // And the next write replaces the broken file
+        restored.Add(1, TriangleCounts, CreateTriangle(1), new InstanceIdGenerator().GetNextId());
+        restored.WriteToFile(LibraryFile);
+        Assert.That(GeometryTemplateLibrary.ReadFromFile(LibraryFile).Count, Is.EqualTo(1));
+    }
+
+    [Test]
+    public void ReadFromFile_MissingFile_ReturnsEmptyLibrary()
+    {
+        var library = GeometryTemplateLibrary.ReadFromFile(LibraryFile);
+        Assert.That(library.Count, Is.EqualTo(0));
+    }
+}
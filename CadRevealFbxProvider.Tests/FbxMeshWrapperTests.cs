@@ -0,0 +1,31 @@
+namespace CadRevealFbxProvider.Tests;
+
+[TestFixture]
+public class FbxMeshWrapperTests
+{
+    private static readonly string TestFile = new("TestSamples/cube_and_instanced_cube_with_parent.fbx");
+
+    [Test]
+    public void CubeMesh_GetMeshCounts_MatchesExtractedGeometry()
+    {
+        using var fbxImporter = new FbxImporter();
+        var cubeNode = fbxImporter.LoadFile(TestFile).GetChild(0).GetChild(0);
+        var meshPtr = FbxMeshWrapper.GetMeshGeometryPtr(cubeNode);
+
+        var counts = FbxMeshWrapper.GetMeshCounts(meshPtr);
+        var mesh = FbxMeshWrapper.GetGeometricData(meshPtr);
+
+        Assert.That(counts.IsEmpty, Is.False);
+        Assert.That(counts.ControlPointCount, Is.EqualTo(8));
+        Assert.That(counts.PolygonCount, Is.EqualTo(6));
+        Assert.That(counts.PolygonVertexCount, Is.EqualTo(24));
+        Assert.That(mesh, Is.Not.Null);
+        Assert.That(mesh.Indices, Has.Length.EqualTo(counts.PolygonVertexCount));
+    }
+
+    [Test]
+    public void NullMesh_GetMeshCounts_Throws()
+    {
+        Assert.Throws<ArgumentException>(() => FbxMeshWrapper.GetMeshCounts(IntPtr.Zero));
+    }
+}
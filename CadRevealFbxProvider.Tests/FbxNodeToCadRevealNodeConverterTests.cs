@@ -11,6 +11,10 @@ using CadRevealComposer.Primitives;
 public class FbxNodeToCadRevealNodeConverterTests
 {
     private static readonly string TestFile = new("TestSamples/cube_and_instanced_cube_with_parent.fbx");
+    private static readonly string TestFileWithFarAwayCube = new("TestSamples/cubes_with_far_away_cube.fbx");
+    private static readonly string TestFileWithNearDuplicateVertex = new(
+        "TestSamples/triangles_with_near_duplicate_vertex.fbx"
+    );
 
     [Test]
     public void CubeAndInstancedCubeParentedToBaseMeshAllWithTransforms_ConvertRecursive_VerifyCorrectTransformations()
@@ -69,4 +73,99 @@ public class FbxNodeToCadRevealNodeConverterTests
             Assert.That(node.Geometries.First(), Is.InstanceOf<T>());
         }
     }
+
+    [TestCase("TestSamples/cube_and_instanced_cube_with_parent.fbx")]
+    [TestCase("TestSamples/green_and_red_cubes.fbx")]
+    [TestCase("TestSamples/correct/TEST-1235678.fbx")]
+    public void CleanModel_ConvertRecursiveWithOutlierDetection_NoNodesAreRemoved(string testFile)
+    {
+        var withoutOutlierDetection = ConvertAllNodesFlat(testFile, outlierDistanceFactor: 0f);
+        var withOutlierDetection = ConvertAllNodesFlat(
+            testFile,
+            FbxNodeToCadRevealNodeConverter.DefaultOutlierDistanceFactor
+        );
+
+        Assert.That(withOutlierDetection.Select(x => x.Name), Is.EqualTo(withoutOutlierDetection.Select(x => x.Name)));
+        Assert.That(
+            withOutlierDetection.SelectMany(x => x.Geometries).Count(),
+            Is.EqualTo(withoutOutlierDetection.SelectMany(x => x.Geometries).Count())
+        );
+    }
+
+    [Test]
+    public void ModelWithFarAwayCube_ConvertRecursiveWithOutlierDetection_FarAwayCubeIsRemoved()
+    {
+        // 20 cubes of 1m in a 13m x 10m grid, and one cube 10km away
+        var withoutOutlierDetection = ConvertAllNodesFlat(TestFileWithFarAwayCube, outlierDistanceFactor: 0f);
+        var withOutlierDetection = ConvertAllNodesFlat(
+            TestFileWithFarAwayCube,
+            FbxNodeToCadRevealNodeConverter.DefaultOutlierDistanceFactor
+        );
+
+        Assert.That(withoutOutlierDetection, Has.Length.EqualTo(22));
+        Assert.That(withoutOutlierDetection.Select(x => x.Name), Has.One.EqualTo("FarAwayPart"));
+        Assert.That(withoutOutlierDetection[0].BoundingBoxAxisAligned!.Max.X, Is.GreaterThan(1000));
+
+        Assert.That(withOutlierDetection, Has.Length.EqualTo(21));
+        Assert.That(withOutlierDetection.Select(x => x.Name), Has.None.EqualTo("FarAwayPart"));
+        Assert.That(withOutlierDetection.SelectMany(x => x.Geometries).Count(), Is.EqualTo(20));
+        Assert.That(withOutlierDetection[0].BoundingBoxAxisAligned!.Max.X, Is.LessThan(20));
+    }
+
+    [Test]
+    public void TrianglesWithNearDuplicateVertex_ConvertRecursiveWithWeldTolerance_VertexIsWeldedAndTrianglesRemoved()
+    {
+        // Four triangles over five vertices, where vertex 3 is 0.001 away from vertex 2. Welding it makes one triangle
+        // degenerate, and the last triangle is a copy of the first.
+        using var fbxImporter = new FbxImporter();
+        var fbxRootNode = fbxImporter.LoadFile(TestFileWithNearDuplicateVertex);
+        var meshPtr = FbxMeshWrapper.GetMeshGeometryPtr(fbxRootNode.GetChild(0));
+
+        var unwelded = FbxMeshWrapper.GetGeometricData(meshPtr);
+        var welded = FbxMeshWrapper.GetGeometricData(meshPtr, weldTolerance: 0.01f, out var stats);
+
+        Assert.That(unwelded, Is.Not.Null);
+        Assert.That(unwelded.Vertices, Has.Length.EqualTo(5));
+        Assert.That(unwelded.TriangleCount, Is.EqualTo(4));
+        Assert.That(welded, Is.Not.Null);
+        Assert.That(welded.Vertices, Has.Length.EqualTo(4));
+        Assert.That(welded.TriangleCount, Is.EqualTo(2));
+        Assert.That(stats.WeldedVertexCount, Is.EqualTo(1));
+        Assert.That(stats.UnreferencedVertexCount, Is.EqualTo(0));
+        Assert.That(stats.DegenerateTriangleCount, Is.EqualTo(1));
+        Assert.That(stats.DuplicateTriangleCount, Is.EqualTo(1));
+
+        var rootNode = FbxNodeToCadRevealNodeConverter.ConvertRecursive(
+            fbxRootNode,
+            new TreeIndexGenerator(),
+            new InstanceIdGenerator(),
+            new NodeNameFiltering(new NodeNameExcludeRegex(null)),
+            null,
+            vertexWeldTolerance: 0.01f
+        );
+
+        Assert.That(rootNode, Is.Not.Null);
+        var triangleMesh = rootNode.Children![0].Geometries.Single() as TriangleMesh;
+        Assert.That(triangleMesh, Is.Not.Null);
+        Assert.That(triangleMesh.Mesh.Vertices, Has.Length.EqualTo(4));
+        Assert.That(triangleMesh.Mesh.TriangleCount, Is.EqualTo(2));
+    }
+
+    private static CadRevealNode[] ConvertAllNodesFlat(string testFile, float outlierDistanceFactor)
+    {
+        using var fbxImporter = new FbxImporter();
+        var fbxRootNode = fbxImporter.LoadFile(testFile);
+
+        var rootNode = FbxNodeToCadRevealNodeConverter.ConvertRecursive(
+            fbxRootNode,
+            new TreeIndexGenerator(),
+            new InstanceIdGenerator(),
+            new NodeNameFiltering(new NodeNameExcludeRegex(null)),
+            null,
+            outlierDistanceFactor: outlierDistanceFactor
+        );
+
+        Assert.That(rootNode, Is.Not.Null);
+        return CadRevealNode.GetAllNodesFlat(rootNode).ToArray();
+    }
 }
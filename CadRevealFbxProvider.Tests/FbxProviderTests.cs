@@ -273,6 +273,102 @@ public class FbxProviderTests
         Assert.That(geometriesToProcess, Has.Exactly(25).TypeOf<InstancedMesh>());
     }
 
+    [TestCase(InputDirectoryCorrect)]
+    public void SampleModel_LoadTwiceWithGeometryTemplateLibrary_WithInstanceThresholdHigh(string inputDir)
+    {
+        var treeIndexGenerator = new TreeIndexGenerator();
+        var instanceIndexGenerator = new InstanceIdGenerator();
+        var geometryTemplateLibrary = new GeometryTemplateLibrary();
+        using var testLoader = new FbxImporter();
+
+        var instanceIdsPerLoad = new List<ulong[]>();
+        for (var i = 0; i < 2; i++)
+        {
+            var rootNode = testLoader.LoadFile(inputDir + "/TEST-1235678.fbx");
+            var rootNodeConverted = FbxNodeToCadRevealNodeConverter.ConvertRecursive(
+                rootNode,
+                treeIndexGenerator,
+                instanceIndexGenerator,
+                new NodeNameFiltering(new NodeNameExcludeRegex(null)),
+                null,
+                minInstanceCountThreshold: 5,
+                geometryTemplateLibrary: geometryTemplateLibrary
+            );
+
+            // The library must not turn the part that is only used twice into instances in the second load
+            var geometriesToProcess = CadRevealNode
+                .GetAllNodesFlat(rootNodeConverted!)
+                .SelectMany(x => x.Geometries)
+                .ToArray();
+            Assert.That(geometriesToProcess, Has.Exactly(2).TypeOf<TriangleMesh>());
+            Assert.That(geometriesToProcess, Has.Exactly(25).TypeOf<InstancedMesh>());
+            instanceIdsPerLoad.Add(geometriesToProcess.OfType<InstancedMesh>().Select(x => x.InstanceId).ToArray());
+        }
+
+        // The second load reuses the templates of the first
+        Assert.That(instanceIdsPerLoad[1], Is.EquivalentTo(instanceIdsPerLoad[0]));
+        Assert.That(geometryTemplateLibrary.Hits, Is.GreaterThan(0));
+    }
+
+    [TestCase(InputDirectoryCorrect)]
+    public void ReadFbxData_TwoCopiesOfSampleModel_InstancesShareTemplates(string inputDir)
+    {
+        var copyDirectory = Directory.CreateTempSubdirectory();
+        try
+        {
+            foreach (var name in new[] { "first.fbx", "second.fbx" })
+            {
+                File.Copy(inputDir + "/TEST-1235678.fbx", Path.Combine(copyDirectory.FullName, name));
+            }
+            var workload = FbxWorkload.CollectWorkload([copyDirectory.FullName]);
+            Assert.That(workload, Has.Length.EqualTo(2));
+
+            (var nodes, _) = FbxWorkload.ReadFbxData(
+                workload,
+                new TreeIndexGenerator(),
+                new InstanceIdGenerator(),
+                new NodeNameFiltering(new NodeNameExcludeRegex(null))
+            );
+
+            // Same counts as loading each file on its own, see SampleFbxModel_Load
+            var geometries = nodes.SelectMany(x => x.Geometries).ToArray();
+            Assert.That(geometries, Has.None.TypeOf<TriangleMesh>());
+            Assert.That(geometries, Has.Exactly(2 * 27).TypeOf<InstancedMesh>());
+
+            // Expecting 3 unique meshes in the source model, shared by both files
+            var instancedMeshes = geometries.OfType<InstancedMesh>().ToArray();
+            Assert.That(instancedMeshes.Select(x => x.InstanceId).Distinct().Count(), Is.EqualTo(3));
+            Assert.That(
+                instancedMeshes.Select(x => x.TemplateMesh).Distinct(ReferenceEqualityComparer.Instance).Count(),
+                Is.EqualTo(3)
+            );
+        }
+        finally
+        {
+            copyDirectory.Delete(recursive: true);
+        }
+    }
+
+    [TestCase(0f, 22)]
+    [TestCase(FbxNodeToCadRevealNodeConverter.DefaultOutlierDistanceFactor, 21)]
+    public void ParseFiles_ModelWithFarAwayCube_OutlierDistanceFactorDecidesIfItIsRemoved(
+        float outlierDistanceFactor,
+        int expectedNodeCount
+    )
+    {
+        var modelFormatProviderFbx = new FbxProvider(outlierDistanceFactor: outlierDistanceFactor);
+
+        (IReadOnlyList<CadRevealNode> nodes, _) = modelFormatProviderFbx.ParseFiles(
+            [new FileInfo("TestSamples/cubes_with_far_away_cube.fbx")],
+            new TreeIndexGenerator(),
+            new InstanceIdGenerator(),
+            new NodeNameFiltering(new NodeNameExcludeRegex(null))
+        );
+
+        Assert.That(nodes, Has.Count.EqualTo(expectedNodeCount));
+        Assert.That(nodes.Any(x => x.Name == "FarAwayPart"), Is.EqualTo(outlierDistanceFactor == 0f));
+    }
+
     [TestCase("TestSamples/missingAttributes")]
     public void ParseFiles_ModelWithNodeMissingAttributes_NodeGetsRemoved(string inputDir)
     {
@@ -0,0 +1,55 @@
+namespace CadRevealFbxProvider.Tests;
+
+[TestFixture]
+public class FbxSceneBoundsWrapperTests
+{
+    private static readonly string TestFile = new("TestSamples/cubes_with_far_away_cube.fbx");
+
+    [Test]
+    public void ModelWithFarAwayCube_GetSceneBounds_FlagsOnlyTheFarAwayCube()
+    {
+        using var fbxImporter = new FbxImporter();
+        var fbxRootNode = fbxImporter.LoadFile(TestFile);
+
+        var sceneBounds = FbxSceneBoundsWrapper.GetSceneBounds(
+            fbxRootNode,
+            FbxNodeToCadRevealNodeConverter.DefaultOutlierDistanceFactor
+        );
+
+        Assert.That(sceneBounds.Nodes, Has.Count.EqualTo(22));
+        Assert.That(sceneBounds.OutlierCount, Is.EqualTo(1));
+        Assert.That(sceneBounds.Bvh, Is.Empty); // Not requested
+
+        for (var i = 0; i < fbxRootNode.GetChildCount(); i++)
+        {
+            var child = fbxRootNode.GetChild(i);
+            var isFarAway = child.GetNodeName() == "FarAwayPart";
+            var childBounds = sceneBounds.Nodes[child.NodeAddress];
+            Assert.That(childBounds.GeometryIsOutlier, Is.EqualTo(isFarAway));
+            Assert.That(childBounds.SubtreeIsOutlier, Is.EqualTo(isFarAway));
+        }
+
+        // The outlier is left out of the bounds of the model
+        var rootBounds = sceneBounds.Nodes[fbxRootNode.NodeAddress].SubtreeBounds;
+        Assert.That(rootBounds, Is.Not.Null);
+        Assert.That(rootBounds.Max.X, Is.LessThan(20));
+    }
+
+    [Test]
+    public void ModelWithFarAwayCube_GetSceneBoundsWithBvh_BvhCoversAllCubesButTheOutlier()
+    {
+        using var fbxImporter = new FbxImporter();
+        var fbxRootNode = fbxImporter.LoadFile(TestFile);
+
+        var sceneBounds = FbxSceneBoundsWrapper.GetSceneBounds(
+            fbxRootNode,
+            FbxNodeToCadRevealNodeConverter.DefaultOutlierDistanceFactor,
+            buildBvh: true
+        );
+
+        Assert.That(sceneBounds.Bvh, Is.Not.Empty);
+        Assert.That(sceneBounds.BvhPrimitiveNodes, Has.Length.EqualTo(20));
+        Assert.That(sceneBounds.BvhPrimitiveNodes, Is.Unique);
+        Assert.That(sceneBounds.BvhPrimitiveNodes.Select(x => sceneBounds.Nodes[x].GeometryIsOutlier), Has.All.False);
+    }
+}
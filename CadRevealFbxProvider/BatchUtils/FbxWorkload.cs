@@ -74,7 +74,10 @@ public static class FbxWorkload
         InstanceIdGenerator instanceIdGenerator,
         NodeNameFiltering nodeNameFiltering,
         IProgress<(string fileName, int progress, int total)>? progressReport = null,
-        IStringInternPool? stringInternPool = null
+        IStringInternPool? stringInternPool = null,
+        GeometryTemplateLibrary? geometryTemplateLibrary = null,
+        float vertexWeldTolerance = 0f,
+        float outlierDistanceFactor = FbxNodeToCadRevealNodeConverter.DefaultOutlierDistanceFactor
     )
     {
         var progress = 0;
@@ -92,6 +95,9 @@ public static class FbxWorkload
 
         Dictionary<string, string> metadata = new();
 
+        // Shared by all files, so instanced catalogue parts are only extracted once per workload
+        geometryTemplateLibrary ??= new GeometryTemplateLibrary(vertexWeldTolerance);
+
         // the local function LoadFbxFile modifies model's metadata as well
         var fbxNodesFlat = workload.SelectMany(LoadFbxFile).ToArray();
 
@@ -102,6 +108,8 @@ public static class FbxWorkload
             );
         }
 
+        geometryTemplateLibrary.PrintStatistics();
+
         return (fbxNodesFlat, new ModelMetadata(metadata));
 
         IReadOnlyList<CadRevealNode> LoadFbxFile((string fbxFilename, string? attributeFilename) filePair)
@@ -136,7 +144,11 @@ public static class FbxWorkload
                 treeIndexGenerator,
                 instanceIdGenerator,
                 nodeNameFiltering,
-                attributes
+                attributes,
+                vertexWeldTolerance: vertexWeldTolerance,
+                geometryTemplateLibrary: geometryTemplateLibrary,
+                // Files with attributes have their trash removed by the attribute validation
+                outlierDistanceFactor: attributes == null ? outlierDistanceFactor : 0f
             );
 
             if (rootNodeConverted == null)
@@ -0,0 +1,268 @@
+namespace CadRevealFbxProvider.BatchUtils;
+
+using System.Numerics;
+using CadRevealComposer.IdProviders;
+using CadRevealComposer.Tessellation;
+
+/// <summary>
+/// Instanced template meshes shared by all files in a workload, keyed by the canonical geometry hash from
+/// <see cref="FbxMeshWrapper.GetGeometryHash"/>. Scaffolds are built from the same catalogue parts, so a part that is
+/// instanced in one file shares its template with the other files instead of being extracted again.
+/// Only geometry that passes the instancing threshold is added and looked up, so the library never changes whether a
+/// part becomes a TriangleMesh or an InstancedMesh.
+///
+/// The hash alone is not trusted: each template keeps the counts of the FBX mesh it was extracted from, and a lookup
+/// with other counts is treated as a miss.
+///
+/// The library can be written to disk and read back in a later run, see the --FbxGeometryTemplateLibraryFile option.
+/// Instance ids are not persisted, templates read from disk get one from the current run's
+/// <see cref="InstanceIdGenerator"/> on first use. Templates that have not been used in
+/// <see cref="MaxRunsWithoutUse"/> runs are left out when writing.
+/// </summary>
+/// <param name="weldTolerance">The weld tolerance the templates were extracted with</param>
+public class GeometryTemplateLibrary(float weldTolerance = 0f)
+{
+    public const int MaxRunsWithoutUse = 10;
+
+    private const int FileFormatVersion = 3;
+    private static readonly char[] FileMagic = ['G', 'T', 'L', 'B'];
+
+    private sealed class Template(Mesh mesh, FbxMeshWrapper.MeshCounts sourceCounts)
+    {
+        public Mesh Mesh => mesh;
+        public FbxMeshWrapper.MeshCounts SourceCounts => sourceCounts;
+        public ulong? InstanceId { get; set; }
+        public bool IsFromFile { get; init; }
+        public int RunsWithoutUse { get; set; }
+        public bool IsUsedThisRun { get; set; }
+    }
+
+    private readonly Dictionary<ulong, Template> _templates = new();
+
+    public float WeldTolerance => weldTolerance;
+
+    public int Hits { get; private set; }
+    public int PersistedHits { get; private set; }
+    public int Misses { get; private set; }
+
+    /// <summary>
+    /// Lookups where the hash matched but the mesh counts did not. Counted as misses as well.
+    /// </summary>
+    public int Collisions { get; private set; }
+
+    public int Count => _templates.Count;
+
+    /// <summary>
+    /// Looks up a template by geometry hash, accepting it only if it was extracted from a mesh with the same
+    /// <paramref name="sourceCounts"/>. Templates without an instance id get one here.
+    /// </summary>
+    public bool TryGetTemplate(
+        ulong geometryHash,
+        FbxMeshWrapper.MeshCounts sourceCounts,
+        InstanceIdGenerator instanceIdGenerator,
+        out (Mesh templateMesh, ulong instanceId) template
+    )
+    {
+        template = default;
+        if (!_templates.TryGetValue(geometryHash, out var entry))
+        {
+            Misses++;
+            return false;
+        }
+
+        if (entry.SourceCounts != sourceCounts)
+        {
+            Collisions++;
+            Misses++;
+            return false;
+        }
+
+        entry.InstanceId ??= instanceIdGenerator.GetNextId();
+        entry.IsUsedThisRun = true;
+        template = (entry.Mesh, entry.InstanceId.Value);
+
+        Hits++;
+        if (entry.IsFromFile)
+            PersistedHits++;
+        return true;
+    }
+
+    /// <summary>
+    /// Adds a template, replacing any other template with the same hash. The mesh must be in its local
+    /// (untransformed) space and must not be modified afterwards.
+    /// </summary>
+    public void Add(ulong geometryHash, FbxMeshWrapper.MeshCounts sourceCounts, Mesh templateMesh, ulong instanceId)
+    {
+        _templates[geometryHash] = new Template(templateMesh, sourceCounts)
+        {
+            InstanceId = instanceId,
+            IsUsedThisRun = true,
+        };
+    }
+
+    public void PrintStatistics()
+    {
+        var lookups = Hits + Misses;
+        Console.WriteLine(
+            $"Geometry template library: {Count:N0} templates. "
+                + $"{Hits:N0} hits ({PersistedHits:N0} from disk) and {Misses:N0} misses "
+                + $"({Collisions:N0} hash collisions). Hit rate {(lookups > 0 ? (float)Hits / lookups : 0):P1}."
+        );
+    }
+
+    /// <summary>
+    /// Writes the library to a temporary file next to <paramref name="file"/> and then moves it into place, so an
+    /// interrupted run never leaves a truncated library behind. Returns the number of templates written.
+    /// </summary>
+    public int WriteToFile(FileInfo file)
+    {
+        var templatesToWrite = _templates
+            .Select(x => (hash: x.Key, template: x.Value, runsWithoutUse: RunsWithoutUseAfterThisRun(x.Value)))
+            .Where(x => x.runsWithoutUse < MaxRunsWithoutUse)
+            .ToArray();
+
+        var temporaryFile = new FileInfo(
+            Path.Combine(file.DirectoryName ?? ".", $"{file.Name}.{Guid.NewGuid():N}.tmp")
+        );
+        try
+        {
+            using (var writer = new BinaryWriter(temporaryFile.Create()))
+            {
+                writer.Write(FileMagic);
+                writer.Write(FileFormatVersion);
+                writer.Write(weldTolerance);
+
+                writer.Write(templatesToWrite.Length);
+                foreach ((ulong hash, Template template, int runsWithoutUse) in templatesToWrite)
+                {
+                    writer.Write(hash);
+                    writer.Write(runsWithoutUse);
+                    writer.Write(template.SourceCounts.ControlPointCount);
+                    writer.Write(template.SourceCounts.PolygonCount);
+                    writer.Write(template.SourceCounts.PolygonVertexCount);
+
+                    var mesh = template.Mesh;
+                    writer.Write(mesh.Error);
+                    writer.Write(mesh.Vertices.Length);
+                    foreach (var vertex in mesh.Vertices)
+                    {
+                        writer.Write(vertex.X);
+                        writer.Write(vertex.Y);
+                        writer.Write(vertex.Z);
+                    }
+
+                    writer.Write(mesh.Indices.Length);
+                    foreach (var index in mesh.Indices)
+                    {
+                        writer.Write(index);
+                    }
+                }
+            }
+
+            File.Move(temporaryFile.FullName, file.FullName, overwrite: true);
+        }
+        finally
+        {
+            temporaryFile.Refresh();
+            if (temporaryFile.Exists)
+                temporaryFile.Delete();
+        }
+
+        return templatesToWrite.Length;
+    }
+
+    /// <summary>
+    /// Reads a library written by <see cref="WriteToFile"/>. Returns an empty library if the file does not exist, or,
+    /// with a warning, if it cannot be read or was written with another format version or weld tolerance. The file
+    /// is then replaced on the next write.
+    /// </summary>
+    public static GeometryTemplateLibrary ReadFromFile(FileInfo file, float weldTolerance = 0f)
+    {
+        if (!file.Exists)
+            return new GeometryTemplateLibrary(weldTolerance);
+
+        try
+        {
+            var library = ReadTemplates(file, weldTolerance);
+            Console.WriteLine($"Read {library.Count:N0} geometry templates from \"{file.FullName}\"");
+            return library;
+        }
+        catch (Exception e) when (e is IOException or InvalidDataException)
+        {
+            Console.WriteLine(
+                $"Warning: Could not read geometry template library \"{file.FullName}\", starting with an empty one. "
+                    + e.Message
+            );
+            return new GeometryTemplateLibrary(weldTolerance);
+        }
+    }
+
+    private static GeometryTemplateLibrary ReadTemplates(FileInfo file, float weldTolerance)
+    {
+        using var reader = new BinaryReader(file.OpenRead());
+        if (!reader.ReadChars(FileMagic.Length).SequenceEqual(FileMagic))
+            throw new InvalidDataException("It is not a geometry template library file.");
+
+        var version = reader.ReadInt32();
+        if (version != FileFormatVersion)
+            throw new InvalidDataException($"It has version {version}, expected {FileFormatVersion}.");
+
+        var fileWeldTolerance = reader.ReadSingle();
+        if (fileWeldTolerance != weldTolerance)
+            throw new InvalidDataException(
+                $"It was written with weld tolerance {fileWeldTolerance}, expected {weldTolerance}."
+            );
+
+        var library = new GeometryTemplateLibrary(weldTolerance);
+        var templateCount = ReadLength(reader, sizeof(ulong));
+        for (var i = 0; i < templateCount; i++)
+        {
+            var hash = reader.ReadUInt64();
+            var runsWithoutUse = reader.ReadInt32();
+            var sourceCounts = new FbxMeshWrapper.MeshCounts(
+                reader.ReadInt32(),
+                reader.ReadInt32(),
+                reader.ReadInt32()
+            );
+            var error = reader.ReadSingle();
+
+            var vertices = new Vector3[ReadLength(reader, 3 * sizeof(float))];
+            for (var v = 0; v < vertices.Length; v++)
+            {
+                vertices[v] = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle());
+            }
+
+            var indices = new uint[ReadLength(reader, sizeof(uint))];
+            for (var j = 0; j < indices.Length; j++)
+            {
+                indices[j] = reader.ReadUInt32();
+            }
+
+            library._templates[hash] = new Template(new Mesh(vertices, indices, error), sourceCounts)
+            {
+                IsFromFile = true,
+                RunsWithoutUse = runsWithoutUse,
+            };
+        }
+
+        return library;
+    }
+
+    /// <summary>
+    /// Reads a length and checks that the file is long enough to hold that many items, so a corrupt length fails
+    /// before anything is allocated for it.
+    /// </summary>
+    private static int ReadLength(BinaryReader reader, int itemSize)
+    {
+        var length = reader.ReadInt32();
+        var remainingBytes = reader.BaseStream.Length - reader.BaseStream.Position;
+        if (length < 0 || (long)length * itemSize > remainingBytes)
+            throw new InvalidDataException("It is truncated or corrupt.");
+        return length;
+    }
+
+    private static int RunsWithoutUseAfterThisRun(Template template)
+    {
+        return template.IsUsedThisRun ? 0 : template.RunsWithoutUse + 1;
+    }
+}
@@ -18,6 +18,40 @@ public static class FbxMeshWrapper
         public IntPtr index_data;
     }
 
+    [StructLayout(LayoutKind.Sequential)]
+    private struct FbxMeshDescriptor
+    {
+        public int control_point_count;
+        public int polygon_count;
+        public int polygon_vertex_count;
+    }
+
+    public readonly record struct MeshCounts(int ControlPointCount, int PolygonCount, int PolygonVertexCount)
+    {
+        public bool IsEmpty => PolygonVertexCount == 0;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MeshCleanupStats
+    {
+        public int WeldedVertexCount;
+        public int UnreferencedVertexCount;
+        public int DegenerateTriangleCount;
+        public int DuplicateTriangleCount;
+
+        public readonly int RemovedVertexCount => WeldedVertexCount + UnreferencedVertexCount;
+        public readonly int RemovedTriangleCount => DegenerateTriangleCount + DuplicateTriangleCount;
+
+        public static MeshCleanupStats operator +(MeshCleanupStats a, MeshCleanupStats b) =>
+            new()
+            {
+                WeldedVertexCount = a.WeldedVertexCount + b.WeldedVertexCount,
+                UnreferencedVertexCount = a.UnreferencedVertexCount + b.UnreferencedVertexCount,
+                DegenerateTriangleCount = a.DegenerateTriangleCount + b.DegenerateTriangleCount,
+                DuplicateTriangleCount = a.DuplicateTriangleCount + b.DuplicateTriangleCount,
+            };
+    }
+
     [DllImport(FbxLib, CallingConvention = CallingConvention.Cdecl, EntryPoint = "mesh_clean_memory")]
     private static extern void mesh_clean_memory(IntPtr meshPtr); //IntPtr in is FbxMesh*
 
@@ -29,13 +63,66 @@ public static class FbxMeshWrapper
         return node_get_mesh(node.NodeAddress);
     }
 
+    [DllImport(FbxLib, CallingConvention = CallingConvention.Cdecl, EntryPoint = "mesh_get_descriptor")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    private static extern bool mesh_get_descriptor(IntPtr mesh, out FbxMeshDescriptor descriptorOut);
+
+    /// <summary>
+    /// Reads the counts the mesh already has, without extracting the geometry.
+    /// </summary>
+    public static MeshCounts GetMeshCounts(IntPtr meshPtr)
+    {
+        if (!mesh_get_descriptor(meshPtr, out var descriptor))
+            throw new ArgumentException("Expected a mesh, got a null pointer.", nameof(meshPtr));
+
+        return new MeshCounts(
+            descriptor.control_point_count,
+            descriptor.polygon_count,
+            descriptor.polygon_vertex_count
+        );
+    }
+
     // the underlying umanaged code allocates memory, you must call mesh_clean_memory to free it later
     [DllImport(FbxLib, CallingConvention = CallingConvention.Cdecl, EntryPoint = "mesh_get_geometry_data")]
     private static extern IntPtr mesh_get_geometry_data(IntPtr mesh); // IntPtr out is FbxMesh*
 
+    // the underlying umanaged code allocates memory, you must call mesh_clean_memory to free it later
+    [DllImport(FbxLib, CallingConvention = CallingConvention.Cdecl, EntryPoint = "mesh_get_geometry_data_welded")]
+    private static extern IntPtr mesh_get_geometry_data_welded(
+        IntPtr mesh,
+        float weldTolerance,
+        out MeshCleanupStats statsOut
+    ); // IntPtr out is FbxMesh*
+
+    [DllImport(FbxLib, CallingConvention = CallingConvention.Cdecl, EntryPoint = "mesh_get_geometry_hash")]
+    private static extern ulong mesh_get_geometry_hash(IntPtr mesh);
+
+    /// <summary>
+    /// Hash of the local space geometry. Identical parts in different files give the same hash.
+    /// </summary>
+    public static ulong GetGeometryHash(IntPtr meshPtr)
+    {
+        return mesh_get_geometry_hash(meshPtr);
+    }
+
     public static Mesh? GetGeometricData(IntPtr meshPtr)
     {
-        var geomPtr = mesh_get_geometry_data(meshPtr);
+        return ToMesh(mesh_get_geometry_data(meshPtr));
+    }
+
+    /// <summary>
+    /// Reads the mesh, welding vertices closer than <paramref name="weldTolerance"/> to each other, and removes the
+    /// degenerate and duplicate triangles and unreferenced vertices left behind. Meshes that are not triangulated are
+    /// only welded. The tolerance is in the units of the mesh itself, not meters, as the unit conversion on import
+    /// only changes the node transforms. Node scaling is not taken into account either.
+    /// </summary>
+    public static Mesh? GetGeometricData(IntPtr meshPtr, float weldTolerance, out MeshCleanupStats stats)
+    {
+        return ToMesh(mesh_get_geometry_data_welded(meshPtr, weldTolerance, out stats));
+    }
+
+    private static Mesh? ToMesh(IntPtr geomPtr)
+    {
         var geom = Marshal.PtrToStructure<FbxMesh>(geomPtr);
 
         // geometry can be invalid if, e.g., the extraction of normal vectors failed
@@ -12,21 +12,47 @@ using Commons.Utils;
 
 public static class FbxNodeToCadRevealNodeConverter
 {
+    /// <summary>
+    /// Geometry further away from the robust extent of the model than this many model sizes is considered trash.
+    /// </summary>
+    public const float DefaultOutlierDistanceFactor = 2f;
+
     public static CadRevealNode? ConvertRecursive(
         FbxNode node,
         TreeIndexGenerator treeIndexGenerator,
         InstanceIdGenerator instanceIdGenerator,
         NodeNameFiltering nodeNameFiltering,
         Dictionary<string, Dictionary<string, string>?>? attributes,
-        int minInstanceCountThreshold = 2
+        int minInstanceCountThreshold = 2,
+        float vertexWeldTolerance = 0f,
+        GeometryTemplateLibrary? geometryTemplateLibrary = null,
+        float outlierDistanceFactor = 0f
     )
     {
+        if (geometryTemplateLibrary != null && geometryTemplateLibrary.WeldTolerance != vertexWeldTolerance)
+            throw new ArgumentException(
+                "The geometry template library was extracted with weld tolerance "
+                    + $"{geometryTemplateLibrary.WeldTolerance}, but the meshes are welded with {vertexWeldTolerance}.",
+                nameof(geometryTemplateLibrary)
+            );
+
         var meshInstanceLookup = new Dictionary<IntPtr, (Mesh templateMesh, ulong instanceId)>();
         IReadOnlySet<IntPtr> geometriesThatShouldBeInstanced = FbxGeometryUtils.GetAllGeomPointersWithXOrMoreUses(
             node,
             minInstanceCountThreshold
         );
-        return ConvertRecursiveInternal(
+        FbxSceneBounds? sceneBounds = null;
+        if (outlierDistanceFactor > 0)
+        {
+            sceneBounds = FbxSceneBoundsWrapper.GetSceneBounds(node, outlierDistanceFactor);
+            if (sceneBounds.OutlierCount > 0)
+                Console.WriteLine(
+                    $"Found {sceneBounds.OutlierCount} parts far away from the rest of the model, they will be skipped."
+                );
+        }
+
+        var meshCleanupStats = new FbxMeshWrapper.MeshCleanupStats();
+        var rootNode = ConvertRecursiveInternal(
             node,
             parent: null,
             treeIndexGenerator,
@@ -34,8 +60,27 @@ public static class FbxNodeToCadRevealNodeConverter
             meshInstanceLookup,
             nodeNameFiltering,
             geometriesThatShouldBeInstanced,
-            attributes
+            attributes,
+            sceneBounds,
+            vertexWeldTolerance,
+            geometryTemplateLibrary,
+            ref meshCleanupStats
         );
+
+        if (vertexWeldTolerance > 0)
+        {
+            Console.WriteLine(
+                $"Welding vertices within {vertexWeldTolerance} (mesh units) "
+                    + $"removed {meshCleanupStats.RemovedVertexCount:N0} vertices "
+                    + $"({meshCleanupStats.WeldedVertexCount:N0} welded, "
+                    + $"{meshCleanupStats.UnreferencedVertexCount:N0} unreferenced) "
+                    + $"and {meshCleanupStats.RemovedTriangleCount:N0} triangles "
+                    + $"({meshCleanupStats.DegenerateTriangleCount:N0} degenerate, "
+                    + $"{meshCleanupStats.DuplicateTriangleCount:N0} duplicate)."
+            );
+        }
+
+        return rootNode;
     }
 
     private static CadRevealNode? ConvertRecursiveInternal(
@@ -46,20 +91,49 @@ public static class FbxNodeToCadRevealNodeConverter
         Dictionary<IntPtr, (Mesh templateMesh, ulong instanceId)> meshInstanceLookup,
         NodeNameFiltering nodeNameFiltering,
         IReadOnlySet<IntPtr> geometriesThatShouldBeInstanced,
-        Dictionary<string, Dictionary<string, string>?>? attributes
+        Dictionary<string, Dictionary<string, string>?>? attributes,
+        FbxSceneBounds? sceneBounds,
+        float vertexWeldTolerance,
+        GeometryTemplateLibrary? geometryTemplateLibrary,
+        ref FbxMeshWrapper.MeshCleanupStats meshCleanupStats
     )
     {
         var name = node.GetNodeName();
         if (nodeNameFiltering.ShouldExcludeNode(name))
             return null;
 
+        // Same trash as described in ValidateNodeAttributes, but found by position so it also works without attributes
+        FbxNodeBounds? nodeBounds = null;
+        if (sceneBounds != null && sceneBounds.Nodes.TryGetValue(node.NodeAddress, out nodeBounds))
+        {
+            if (nodeBounds.SubtreeIsOutlier)
+            {
+                Console.WriteLine("Skipping node far away from the model: " + name);
+                return null;
+            }
+        }
+
         var id = treeIndexGenerator.GetNextId();
-        var geometry = ReadGeometry(id, node, instanceIdGenerator, meshInstanceLookup, geometriesThatShouldBeInstanced);
 
         if (attributes != null)
             if (!ValidateNodeAttributes(attributes, name))
                 return null;
 
+        // Only extract the geometry of nodes that are kept
+        var geometry =
+            nodeBounds is { GeometryIsOutlier: true }
+                ? null
+                : ReadGeometry(
+                    id,
+                    node,
+                    instanceIdGenerator,
+                    meshInstanceLookup,
+                    geometriesThatShouldBeInstanced,
+                    vertexWeldTolerance,
+                    geometryTemplateLibrary,
+                    ref meshCleanupStats
+                );
+
         var cadRevealNode = new CadRevealNode
         {
             TreeIndex = id,
@@ -81,7 +155,11 @@ public static class FbxNodeToCadRevealNodeConverter
                 meshInstanceLookup,
                 nodeNameFiltering,
                 geometriesThatShouldBeInstanced,
-                attributes
+                attributes,
+                sceneBounds,
+                vertexWeldTolerance,
+                geometryTemplateLibrary,
+                ref meshCleanupStats
             );
 
             if (childCadRevealNode != null)
@@ -125,7 +203,10 @@ public static class FbxNodeToCadRevealNodeConverter
         FbxNode node,
         InstanceIdGenerator instanceIdGenerator,
         IDictionary<IntPtr, (Mesh templateMesh, ulong instanceId)> meshInstanceLookup,
-        IReadOnlySet<IntPtr> geometriesThatShouldBeInstanced
+        IReadOnlySet<IntPtr> geometriesThatShouldBeInstanced,
+        float vertexWeldTolerance,
+        GeometryTemplateLibrary? geometryTemplateLibrary,
+        ref FbxMeshWrapper.MeshCleanupStats meshCleanupStats
     )
     {
         var nodeGeometryPtr = FbxMeshWrapper.GetMeshGeometryPtr(node);
@@ -160,7 +241,53 @@ public static class FbxNodeToCadRevealNodeConverter
             return instancedMeshCopy;
         }
 
-        var mesh = FbxMeshWrapper.GetGeometricData(nodeGeometryPtr);
+        var meshCounts = FbxMeshWrapper.GetMeshCounts(nodeGeometryPtr);
+        if (meshCounts.IsEmpty && !geometriesThatShouldBeInstanced.Contains(nodeGeometryPtr))
+        {
+            // No need to extract it to find out
+            Console.Error.WriteLine("Found mesh with zero vertices: " + node.GetNodeName() + ". (ignoring). ");
+            return null;
+        }
+
+        // Parts already instanced in another file (or an earlier run) share the template instead of being extracted
+        // again. Only geometry that is instanced in this file is looked up, so the instancing threshold still decides.
+        // The counts guard against hash collisions.
+        ulong? geometryHash = null;
+        if (geometryTemplateLibrary != null && geometriesThatShouldBeInstanced.Contains(nodeGeometryPtr))
+        {
+            geometryHash = FbxMeshWrapper.GetGeometryHash(nodeGeometryPtr);
+            if (
+                geometryTemplateLibrary.TryGetTemplate(
+                    geometryHash.Value,
+                    meshCounts,
+                    instanceIdGenerator,
+                    out var template
+                )
+            )
+            {
+                meshInstanceLookup.Add(nodeGeometryPtr, template);
+                return new InstancedMesh(
+                    template.instanceId,
+                    template.templateMesh,
+                    meshTransform,
+                    treeIndex,
+                    color,
+                    template.templateMesh.CalculateAxisAlignedBoundingBox(meshTransform)
+                );
+            }
+        }
+
+        Mesh? mesh;
+        if (vertexWeldTolerance > 0)
+        {
+            mesh = FbxMeshWrapper.GetGeometricData(nodeGeometryPtr, vertexWeldTolerance, out var stats);
+            meshCleanupStats += stats;
+        }
+        else
+        {
+            mesh = FbxMeshWrapper.GetGeometricData(nodeGeometryPtr);
+        }
+
         if (mesh == null)
         {
             throw new UserFriendlyLogException(
@@ -173,6 +300,8 @@ public static class FbxNodeToCadRevealNodeConverter
         {
             ulong instanceId = instanceIdGenerator.GetNextId();
             meshInstanceLookup.Add(nodeGeometryPtr, (mesh, instanceId));
+            if (geometryHash != null)
+                geometryTemplateLibrary!.Add(geometryHash.Value, meshCounts, mesh, instanceId);
             var instancedMesh = new InstancedMesh(
                 instanceId,
                 mesh,
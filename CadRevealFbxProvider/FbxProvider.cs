@@ -13,7 +13,22 @@ using CadRevealComposer.Utils;
 using Commons;
 using UserFriendlyLogger;
 
-public class FbxProvider : IModelFormatProvider
+/// <param name="geometryTemplateLibraryFile">
+/// Optional file to read instanced geometry templates from before parsing, and to write them to afterwards.
+/// Lets a later run share the templates of catalogue parts instead of extracting them again.
+/// </param>
+/// <param name="vertexWeldTolerance">
+/// Welds mesh vertices closer than this, in the units the meshes are stored in. 0 disables welding.
+/// </param>
+/// <param name="outlierDistanceFactor">
+/// Parts further away from the model than this many times its size are removed, in files without attributes.
+/// 0 disables the removal.
+/// </param>
+public class FbxProvider(
+    FileInfo? geometryTemplateLibraryFile = null,
+    float vertexWeldTolerance = 0f,
+    float outlierDistanceFactor = FbxNodeToCadRevealNodeConverter.DefaultOutlierDistanceFactor
+) : IModelFormatProvider
 {
     public (IReadOnlyList<CadRevealNode>, ModelMetadata?) ParseFiles(
         IEnumerable<FileInfo> filesToParse,
@@ -40,6 +55,10 @@ public class FbxProvider : IModelFormatProvider
             });
 
             var stringInternPool = new BenStringInternPool(new SharedInternPool());
+            var geometryTemplateLibrary =
+                geometryTemplateLibraryFile != null
+                    ? GeometryTemplateLibrary.ReadFromFile(geometryTemplateLibraryFile, vertexWeldTolerance)
+                    : new GeometryTemplateLibrary(vertexWeldTolerance);
 
             (var nodes, var metadata) = FbxWorkload.ReadFbxData(
                 workload,
@@ -47,8 +66,19 @@ public class FbxProvider : IModelFormatProvider
                 instanceIdGenerator,
                 nodeNameFiltering,
                 progressReport,
-                stringInternPool
+                stringInternPool,
+                geometryTemplateLibrary,
+                vertexWeldTolerance,
+                outlierDistanceFactor
             );
+            if (geometryTemplateLibraryFile != null)
+            {
+                var writtenTemplateCount = geometryTemplateLibrary.WriteToFile(geometryTemplateLibraryFile);
+                Console.WriteLine(
+                    $"Wrote {writtenTemplateCount:N0} geometry templates to \"{geometryTemplateLibraryFile.FullName}\""
+                );
+            }
+
             var fileSizesTotal = workload.Sum(w => new FileInfo(w.fbxFilename).Length);
             teamCityReadFbxFilesLogBlock.CloseBlock();
 
@@ -0,0 +1,161 @@
+﻿namespace CadRevealFbxProvider;
+
+using System.Numerics;
+using System.Runtime.InteropServices;
+using CadRevealComposer;
+
+/// <summary>
+/// World space bounds of a node, as computed by cfbx.
+/// </summary>
+/// <param name="GeometryBounds">Bounds of the node's own mesh, null if it has none</param>
+/// <param name="SubtreeBounds">
+/// Bounds of the node and all its children, excluding outliers. Null if there is no such geometry
+/// </param>
+/// <param name="GeometryIsOutlier">The node's mesh is far away from the rest of the model</param>
+/// <param name="SubtreeIsOutlier">The node and its children contain outlier geometry and nothing else</param>
+public record FbxNodeBounds(
+    int ParentIndex,
+    BoundingBox? GeometryBounds,
+    BoundingBox? SubtreeBounds,
+    bool GeometryIsOutlier,
+    bool SubtreeIsOutlier
+);
+
+/// <summary>
+/// Flattened BVH node. Internal nodes have <see cref="Count"/> == 0, their left child is the next node in the list
+/// and <see cref="FirstOrRight"/> is the index of the right child. Leaves cover
+/// <see cref="FbxSceneBounds.BvhPrimitiveNodes"/>[FirstOrRight..FirstOrRight + Count].
+/// </summary>
+public readonly record struct FbxBvhNode(BoundingBox Bounds, int FirstOrRight, int Count)
+{
+    public bool IsLeaf => Count > 0;
+}
+
+/// <param name="Nodes">All nodes, depth first in child order</param>
+/// <param name="Bvh">
+/// SAH BVH over the geometry of all nodes that are not outliers, root first. Empty unless requested
+/// </param>
+/// <param name="BvhPrimitiveNodes">The nodes the BVH leaves refer to</param>
+public record FbxSceneBounds(
+    IReadOnlyDictionary<IntPtr, FbxNodeBounds> Nodes,
+    FbxBvhNode[] Bvh,
+    IntPtr[] BvhPrimitiveNodes,
+    int OutlierCount
+);
+
+public static class FbxSceneBoundsWrapper
+{
+    private const string FbxLib = FbxSdkWrapper.FbxLibraryName;
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct FbxBounds
+    {
+        public float min_x;
+        public float min_y;
+        public float min_z;
+        public float max_x;
+        public float max_y;
+        public float max_z;
+
+        public BoundingBox? ToBoundingBox() =>
+            min_x > max_x ? null : new BoundingBox(new Vector3(min_x, min_y, min_z), new Vector3(max_x, max_y, max_z));
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct FbxNativeNodeBounds
+    {
+        public IntPtr node;
+        public int parent_index;
+
+        [MarshalAs(UnmanagedType.I1)]
+        public bool has_geometry;
+
+        [MarshalAs(UnmanagedType.I1)]
+        public bool geometry_is_outlier;
+
+        [MarshalAs(UnmanagedType.I1)]
+        public bool subtree_is_outlier;
+
+        public FbxBounds geometry_bounds;
+        public FbxBounds subtree_bounds;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct FbxNativeBvhNode
+    {
+        public FbxBounds bounds;
+        public int first_or_right;
+        public int count;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct FbxNativeSceneBounds
+    {
+        public int node_count;
+        public IntPtr nodes;
+        public int bvh_node_count;
+        public IntPtr bvh_nodes;
+        public int bvh_primitive_count;
+        public IntPtr bvh_primitive_indices;
+        public int outlier_count;
+    }
+
+    [DllImport(FbxLib, CallingConvention = CallingConvention.Cdecl, EntryPoint = "bounds_clean_memory")]
+    private static extern void bounds_clean_memory(IntPtr boundsPtr); //IntPtr in is ExportableSceneBounds*
+
+    // the underlying umanaged code allocates memory, you must call bounds_clean_memory to free it later
+    [DllImport(FbxLib, CallingConvention = CallingConvention.Cdecl, EntryPoint = "bounds_get_scene_bounds")]
+    private static extern IntPtr bounds_get_scene_bounds(
+        IntPtr root,
+        float outlierDistanceFactor,
+        [MarshalAs(UnmanagedType.I1)] bool buildBvh
+    ); // IntPtr out is ExportableSceneBounds*
+
+    /// <summary>
+    /// Computes the world space bounds of all nodes below <paramref name="root"/> in one native pass, and optionally
+    /// builds a BVH over them. Geometry that does not touch the robust extent of the model (the interquartile range of
+    /// the part centers), grown by <paramref name="outlierDistanceFactor"/> times its size, is flagged as outlier.
+    /// Models with fewer than five parts have no outliers. Zero disables outlier detection.
+    /// </summary>
+    public static FbxSceneBounds GetSceneBounds(FbxNode root, float outlierDistanceFactor, bool buildBvh = false)
+    {
+        var boundsPtr = bounds_get_scene_bounds(root.NodeAddress, outlierDistanceFactor, buildBvh);
+        var bounds = Marshal.PtrToStructure<FbxNativeSceneBounds>(boundsPtr);
+
+        var nodeSize = Marshal.SizeOf<FbxNativeNodeBounds>();
+        var nodeAddresses = new IntPtr[bounds.node_count];
+        var nodes = new Dictionary<IntPtr, FbxNodeBounds>(bounds.node_count);
+        for (var i = 0; i < bounds.node_count; i++)
+        {
+            var node = Marshal.PtrToStructure<FbxNativeNodeBounds>(bounds.nodes + i * nodeSize);
+            nodeAddresses[i] = node.node;
+            nodes[node.node] = new FbxNodeBounds(
+                node.parent_index,
+                node.has_geometry ? node.geometry_bounds.ToBoundingBox() : null,
+                node.subtree_bounds.ToBoundingBox(),
+                node.geometry_is_outlier,
+                node.subtree_is_outlier
+            );
+        }
+
+        var bvhNodeSize = Marshal.SizeOf<FbxNativeBvhNode>();
+        var bvh = new FbxBvhNode[bounds.bvh_node_count];
+        for (var i = 0; i < bvh.Length; i++)
+        {
+            var bvhNode = Marshal.PtrToStructure<FbxNativeBvhNode>(bounds.bvh_nodes + i * bvhNodeSize);
+            bvh[i] = new FbxBvhNode(bvhNode.bounds.ToBoundingBox()!, bvhNode.first_or_right, bvhNode.count);
+        }
+
+        var primitiveIndices = new int[bounds.bvh_primitive_count];
+        Marshal.Copy(bounds.bvh_primitive_indices, primitiveIndices, 0, primitiveIndices.Length);
+        var outlierCount = bounds.outlier_count;
+        bounds_clean_memory(boundsPtr);
+
+        return new FbxSceneBounds(
+            nodes,
+            bvh,
+            primitiveIndices.Select(i => nodeAddresses[i]).ToArray(),
+            outlierCount
+        );
+    }
+}
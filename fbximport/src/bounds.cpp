@@ -0,0 +1,161 @@
+#include "bounds.h"
+#include "spatial.h"
+#include <fbxsdk.h>
+#include <algorithm>
+#include <vector>
+
+using namespace fbxsdk;
+using namespace std;
+
+struct SceneNode
+{
+    FbxNode* node;
+    int parent_index;
+    bool has_geometry;
+    cfbx::Aabb geometry_bounds;
+};
+
+// same composition as node_get_transform and node_get_geometric_transform, which the provider uses for the meshes
+static FbxAMatrix GetTransform(const FbxDouble3& t, const FbxDouble3& r, const FbxDouble3& s)
+{
+    FbxQuaternion q;
+    q.ComposeSphericalXYZ(FbxVector4(r[0], r[1], r[2]));
+    FbxAMatrix transform;
+    transform.SetTQS(FbxVector4(t[0], t[1], t[2]), q, FbxVector4(s[0], s[1], s[2]));
+    return transform;
+}
+
+static cfbx::Aabb GetMeshWorldBounds(FbxMesh* mesh, const FbxAMatrix& transform)
+{
+    cfbx::Aabb bounds;
+    const auto controlPoints = mesh->GetControlPoints();
+    const auto fbxVertexPositionsCount = mesh->GetPolygonVertexCount();
+    const auto fbxVertexPositionIndexArray = mesh->GetPolygonVertices();
+
+    // only the control points used by polygons count, same as in mesh_get_geometry_data
+    vector<bool> visited(mesh->GetControlPointsCount(), false);
+    for (int i = 0; i < fbxVertexPositionsCount; i++)
+    {
+        const int index = fbxVertexPositionIndexArray[i];
+        if (visited[index])
+            continue;
+        visited[index] = true;
+
+        const auto p = transform.MultT(controlPoints[index]);
+        bounds.extend((float)p[0], (float)p[1], (float)p[2]);
+    }
+
+    return bounds;
+}
+
+static void CollectNodes(FbxNode* node, int parent_index, const FbxAMatrix& parent_transform, vector<SceneNode>& nodes)
+{
+    const auto transform = parent_transform * GetTransform(node->LclTranslation.Get(), node->LclRotation.Get(), node->LclScaling.Get());
+
+    SceneNode scene_node{ node, parent_index, false, cfbx::Aabb() };
+    const auto attr = node->GetNodeAttribute();
+    if (attr != nullptr && attr->GetAttributeType() == FbxNodeAttribute::eMesh)
+    {
+        const auto geometric_transform = GetTransform(node->GeometricTranslation.Get(), node->GeometricRotation.Get(), node->GeometricScaling.Get());
+        scene_node.has_geometry = true;
+        scene_node.geometry_bounds = GetMeshWorldBounds(static_cast<FbxMesh*>(attr), transform * geometric_transform);
+    }
+
+    const int index = (int)nodes.size();
+    nodes.push_back(scene_node);
+
+    for (int i = 0; i < node->GetChildCount(); i++)
+    {
+        CollectNodes(node->GetChild(i), index, transform, nodes);
+    }
+}
+
+static Bounds ToBounds(const cfbx::Aabb& aabb)
+{
+    return { aabb.min[0], aabb.min[1], aabb.min[2], aabb.max[0], aabb.max[1], aabb.max[2] };
+}
+
+// this function allocates memory
+// there should be a corresponding bounds_clean_memory call for each call of this function
+ExportableSceneBounds* bounds_get_scene_bounds(CFbxNode* root, float outlier_distance_factor, bool build_bvh)
+{
+    vector<SceneNode> nodes;
+    if (root != nullptr)
+    {
+        FbxAMatrix identity;
+        CollectNodes(static_cast<FbxNode*>(root), -1, identity, nodes);
+    }
+
+    vector<cfbx::Aabb> geometry_bounds(nodes.size());
+    std::transform(nodes.begin(), nodes.end(), geometry_bounds.begin(), [](const SceneNode& n) { return n.geometry_bounds; });
+    const auto outliers = cfbx::find_outliers(geometry_bounds, outlier_distance_factor);
+
+    // children come after their parent, so walking backwards visits every child before its parent
+    vector<cfbx::Aabb> subtree_bounds(nodes.size());
+    vector<bool> subtree_has_outliers(nodes.size(), false);
+    vector<bool> subtree_has_kept_geometry(nodes.size(), false);
+    for (int i = (int)nodes.size() - 1; i >= 0; i--)
+    {
+        if (outliers[i])
+        {
+            subtree_has_outliers[i] = true;
+            geometry_bounds[i] = cfbx::Aabb(); // leave outliers out of the bvh
+        }
+        else if (nodes[i].has_geometry && !geometry_bounds[i].is_empty())
+        {
+            subtree_has_kept_geometry[i] = true;
+            subtree_bounds[i].extend(geometry_bounds[i]);
+        }
+
+        const int parent = nodes[i].parent_index;
+        if (parent >= 0)
+        {
+            subtree_bounds[parent].extend(subtree_bounds[i]);
+            subtree_has_outliers[parent] = subtree_has_outliers[parent] || subtree_has_outliers[i];
+            subtree_has_kept_geometry[parent] = subtree_has_kept_geometry[parent] || subtree_has_kept_geometry[i];
+        }
+    }
+
+    // the bvh is only built on request, without it the arrays below are empty
+    cfbx::Bvh bvh;
+    if (build_bvh)
+        bvh = cfbx::build_sah_bvh(geometry_bounds);
+
+    ExportableSceneBounds* bounds_out = new ExportableSceneBounds();
+    bounds_out->node_count = nodes.size();
+    bounds_out->nodes = new NodeBounds[nodes.size()];
+    bounds_out->outlier_count = std::count(outliers.begin(), outliers.end(), true);
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        auto& node_out = bounds_out->nodes[i];
+        node_out.node = static_cast<CFbxNode*>(nodes[i].node);
+        node_out.parent_index = nodes[i].parent_index;
+        node_out.has_geometry = nodes[i].has_geometry;
+        node_out.geometry_is_outlier = outliers[i];
+        node_out.subtree_is_outlier = subtree_has_outliers[i] && !subtree_has_kept_geometry[i];
+        node_out.geometry_bounds = ToBounds(nodes[i].geometry_bounds);
+        node_out.subtree_bounds = ToBounds(subtree_bounds[i]);
+    }
+
+    bounds_out->bvh_node_count = bvh.nodes.size();
+    bounds_out->bvh_nodes = new BvhNode[bvh.nodes.size()];
+    for (size_t i = 0; i < bvh.nodes.size(); i++)
+    {
+        bounds_out->bvh_nodes[i] = { ToBounds(bvh.nodes[i].bounds), bvh.nodes[i].first_or_right, bvh.nodes[i].count };
+    }
+
+    bounds_out->bvh_primitive_count = bvh.primitive_indices.size();
+    bounds_out->bvh_primitive_indices = new int[bvh.primitive_indices.size()];
+    std::copy(bvh.primitive_indices.begin(), bvh.primitive_indices.end(), bounds_out->bvh_primitive_indices);
+
+    return bounds_out;
+}
+
+void bounds_clean_memory(ExportableSceneBounds* bounds)
+{
+    if (bounds)
+    {
+        delete bounds;
+        bounds = nullptr;
+    }
+}
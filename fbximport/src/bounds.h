@@ -0,0 +1,11 @@
+#ifndef __CFBX_BOUNDS_H__
+#define __CFBX_BOUNDS_H__
+
+#include "common.h"
+
+extern "C" {
+    CFBX_API void bounds_clean_memory(ExportableSceneBounds* bounds);
+    CFBX_API ExportableSceneBounds* bounds_get_scene_bounds(CFbxNode* root, float outlier_distance_factor, bool build_bvh);
+}
+
+#endif // __CFBX_BOUNDS_H__
@@ -56,6 +56,108 @@ extern "C"
         }
     };
 
+    // vertex positions are stored as 16-bit offsets into the local bounding box of the mesh
+    // dequantize with position = dequant_offset + vertex_position_data * dequant_scale (per component)
+    // max_error is the largest distance between an original vertex and its dequantized position
+    CFBX_API struct ExportableQuantizedMesh
+    {
+        bool valid;
+        int vertex_count;
+        int index_count;
+        unsigned short *vertex_position_data;
+        int *index_data;
+        float dequant_offset_x;
+        float dequant_offset_y;
+        float dequant_offset_z;
+        float dequant_scale_x;
+        float dequant_scale_y;
+        float dequant_scale_z;
+        float max_error;
+
+        ~ExportableQuantizedMesh()
+        {
+            if (vertex_position_data)
+            {
+                delete[] vertex_position_data;
+                vertex_position_data = nullptr;
+            }
+
+            if (index_data)
+            {
+                delete[] index_data;
+                index_data = nullptr;
+            }
+        }
+    };
+
+    // filled in by mesh_get_geometry_data_welded, memory is provided by the caller
+    CFBX_API struct MeshCleanupStats
+    {
+        int welded_vertex_count;
+        int unreferenced_vertex_count;
+        int degenerate_triangle_count;
+        int duplicate_triangle_count;
+    };
+
+    // min > max when empty
+    CFBX_API struct Bounds
+    {
+        float min_x;
+        float min_y;
+        float min_z;
+        float max_x;
+        float max_y;
+        float max_z;
+    };
+
+    // cheap summary of a mesh, available without extracting the geometry
+    CFBX_API struct MeshDescriptor
+    {
+        int control_point_count;
+        int polygon_count;
+        int polygon_vertex_count;
+    };
+
+    CFBX_API struct NodeBounds
+    {
+        CFbxNode* node;
+        int parent_index;
+        bool has_geometry;
+        bool geometry_is_outlier;
+        bool subtree_is_outlier; // the subtree contains outlier geometry and nothing else
+        Bounds geometry_bounds; // world space bounds of the node's own mesh
+        Bounds subtree_bounds; // world space bounds of the node and its children, excluding outliers
+    };
+
+    // internal nodes have count == 0, their left child is the next node and first_or_right is the right child
+    // leaves cover bvh_primitive_indices[first_or_right, first_or_right + count)
+    CFBX_API struct BvhNode
+    {
+        Bounds bounds;
+        int first_or_right;
+        int count;
+    };
+
+    // nodes are listed depth first in child order, so parents always come before their children
+    // the bvh is built over the geometry of the nodes that are not outliers, bvh_primitive_indices refers to nodes
+    CFBX_API struct ExportableSceneBounds
+    {
+        int node_count;
+        NodeBounds* nodes;
+        int bvh_node_count;
+        BvhNode* bvh_nodes;
+        int bvh_primitive_count;
+        int* bvh_primitive_indices;
+        int outlier_count;
+
+        ~ExportableSceneBounds()
+        {
+            delete[] nodes;
+            delete[] bvh_nodes;
+            delete[] bvh_primitive_indices;
+        }
+    };
+
     CFBX_API struct Color
     {
         float r;
@@ -1,28 +1,22 @@
 #include "mesh.h"
+#include "mesh_cleanup.h"
+#include "mesh_quantization.h"
 #include <fbxsdk.h>
 #include <vector>
 #include <map>
 #include <tuple>
 #include <set>
 #include <iostream>
+#include <cstdint>
+#include <cstring>
 
 using namespace fbxsdk;
 using namespace std;
 typedef std::tuple<float, float, float> vertex_tuple;
 
-// this function allocates memory
-// there should be a corresponding mesh_clean call for each call of this function
-// it should never return nullptr, if the mesh is invalid for some reason, set the valid field to false
-ExportableMesh* mesh_get_geometry_data(CFbxMesh* geometry)
+// Reads the polygon vertices of the mesh, merging vertices with bit-identical positions
+static void read_unique_vertices(FbxMesh* mesh, vector<float>& lMeshOutVertexPositions, vector<int>& lMeshOutVertexIndices)
 {
-    ExportableMesh* mesh_out_tmp = new ExportableMesh();
-    mesh_out_tmp->vertex_count = 0;
-    mesh_out_tmp->vertex_position_data = nullptr;
-    mesh_out_tmp->index_count = 0;
-    mesh_out_tmp->index_data = nullptr;
-
-    auto mesh = (FbxMesh*)geometry;
-
     // GetPolygonVertexCount() can be smaller than the value returned by GetControlPointsCount() (meaning that not all
     // of the control points stored in the object are used to define the mesh). However, typically it will be much
     // bigger since any given control point can be used to define a vertex on multiple polygons.
@@ -31,10 +25,8 @@ ExportableMesh* mesh_get_geometry_data(CFbxMesh* geometry)
     auto fbxVertexPositionIndexArray = mesh->GetPolygonVertices();
     auto controlPointCount = mesh->GetControlPointsCount();
 
-    vector<float> lMeshOutVertexPositions;
-    vector<int> lMeshOutVertexIndices;
     std::map<vertex_tuple, int> vertex_data;
-    
+
     for (auto i = 0; i < fbxVertexPositionsCount; i++)
     {
         // Retrieve vertex index and position. If we have choosen to ignore the vertex surface normal,
@@ -66,7 +58,11 @@ ExportableMesh* mesh_get_geometry_data(CFbxMesh* geometry)
             lMeshOutVertexIndices.push_back(newIndexCandidate);
         }
     }
+}
 
+static ExportableMesh* create_exportable_mesh(const vector<float>& lMeshOutVertexPositions, const vector<int>& lMeshOutVertexIndices)
+{
+    ExportableMesh* mesh_out_tmp = new ExportableMesh();
     mesh_out_tmp->valid = true;
     mesh_out_tmp->index_count = lMeshOutVertexIndices.size();
     mesh_out_tmp->vertex_count = lMeshOutVertexPositions.size() / 3;
@@ -80,6 +76,141 @@ ExportableMesh* mesh_get_geometry_data(CFbxMesh* geometry)
     return mesh_out_tmp;
 }
 
+// this function allocates memory
+// there should be a corresponding mesh_clean call for each call of this function
+// it should never return nullptr, if the mesh is invalid for some reason, set the valid field to false
+ExportableMesh* mesh_get_geometry_data(CFbxMesh* geometry)
+{
+    auto mesh = (FbxMesh*)geometry;
+
+    vector<float> lMeshOutVertexPositions;
+    vector<int> lMeshOutVertexIndices;
+    read_unique_vertices(mesh, lMeshOutVertexPositions, lMeshOutVertexIndices);
+
+    return create_exportable_mesh(lMeshOutVertexPositions, lMeshOutVertexIndices);
+}
+
+// same as mesh_get_geometry_data, but also welds vertices closer than weld_tolerance and removes the degenerate and
+// duplicate triangles this produces, see cfbx::weld_and_clean_mesh
+// weld_tolerance is in the units of the mesh's control points, the scene unit conversion only changes node transforms
+// meshes that are not triangulated are only welded
+// stats_out is optional
+ExportableMesh* mesh_get_geometry_data_welded(CFbxMesh* geometry, float weld_tolerance, MeshCleanupStats* stats_out)
+{
+    auto mesh = (FbxMesh*)geometry;
+
+    vector<float> lMeshOutVertexPositions;
+    vector<int> lMeshOutVertexIndices;
+    read_unique_vertices(mesh, lMeshOutVertexPositions, lMeshOutVertexIndices);
+
+    const auto stats = cfbx::weld_and_clean_mesh(
+        lMeshOutVertexPositions, lMeshOutVertexIndices, weld_tolerance, mesh->IsTriangleMesh());
+    if (stats_out)
+        *stats_out = stats;
+
+    return create_exportable_mesh(lMeshOutVertexPositions, lMeshOutVertexIndices);
+}
+
+// this function allocates memory
+// there should be a corresponding mesh_quantized_clean_memory call for each call of this function
+ExportableQuantizedMesh* mesh_get_geometry_data_quantized(CFbxMesh* geometry)
+{
+    auto mesh = (FbxMesh*)geometry;
+
+    vector<float> lMeshOutVertexPositions;
+    vector<int> lMeshOutVertexIndices;
+    read_unique_vertices(mesh, lMeshOutVertexPositions, lMeshOutVertexIndices);
+
+    const auto quantized = cfbx::quantize_positions(lMeshOutVertexPositions);
+
+    ExportableQuantizedMesh* mesh_out_tmp = new ExportableQuantizedMesh();
+    mesh_out_tmp->valid = true;
+    mesh_out_tmp->index_count = lMeshOutVertexIndices.size();
+    mesh_out_tmp->vertex_count = quantized.positions.size() / 3;
+    mesh_out_tmp->dequant_offset_x = quantized.offset[0];
+    mesh_out_tmp->dequant_offset_y = quantized.offset[1];
+    mesh_out_tmp->dequant_offset_z = quantized.offset[2];
+    mesh_out_tmp->dequant_scale_x = quantized.scale[0];
+    mesh_out_tmp->dequant_scale_y = quantized.scale[1];
+    mesh_out_tmp->dequant_scale_z = quantized.scale[2];
+    mesh_out_tmp->max_error = quantized.max_error;
+
+    mesh_out_tmp->index_data = new int[mesh_out_tmp->index_count];
+    mesh_out_tmp->vertex_position_data = new unsigned short[quantized.positions.size()];
+
+    std::copy(lMeshOutVertexIndices.begin(), lMeshOutVertexIndices.end(), mesh_out_tmp->index_data);
+    std::copy(quantized.positions.begin(), quantized.positions.end(), mesh_out_tmp->vertex_position_data);
+
+    return mesh_out_tmp;
+}
+
+// fills in the caller provided descriptor from the counts the mesh already has, without touching the geometry
+// returns false, and leaves the descriptor untouched, if there is no mesh
+bool mesh_get_descriptor(CFbxMesh* geometry, MeshDescriptor* descriptor_out)
+{
+    if (geometry == nullptr || descriptor_out == nullptr)
+        return false;
+
+    auto mesh = (FbxMesh*)geometry;
+    descriptor_out->control_point_count = mesh->GetControlPointsCount();
+    descriptor_out->polygon_count = mesh->GetPolygonCount();
+    descriptor_out->polygon_vertex_count = mesh->GetPolygonVertexCount();
+    return true;
+}
+
+static void hash_bytes(uint64_t& hash, const void* data, size_t size)
+{
+    // 64-bit FNV-1a
+    const auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+// Hashes the polygon layout and the vertex positions (as the floats mesh_get_geometry_data exports) in polygon vertex
+// order. Identical parts give the same hash regardless of which file or FbxMesh object they come from, without
+// extracting the geometry.
+unsigned long long mesh_get_geometry_hash(CFbxMesh* geometry)
+{
+    auto mesh = (FbxMesh*)geometry;
+    uint64_t hash = 14695981039346656037ull;
+
+    const int polygonCount = mesh->GetPolygonCount();
+    hash_bytes(hash, &polygonCount, sizeof(polygonCount));
+
+    for (int polygon = 0; polygon < polygonCount; polygon++)
+    {
+        const int polygonSize = mesh->GetPolygonSize(polygon);
+        hash_bytes(hash, &polygonSize, sizeof(polygonSize));
+
+        for (int vertex = 0; vertex < polygonSize; vertex++)
+        {
+            auto lVertex = mesh->GetControlPointAt(mesh->GetPolygonVertex(polygon, vertex));
+            for (int axis = 0; axis < 3; axis++)
+            {
+                // adding zero turns -0.0f into 0.0f, so the two are hashed the same
+                const float value = (float)lVertex[axis] + 0.0f;
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                hash_bytes(hash, &bits, sizeof(bits));
+            }
+        }
+    }
+
+    return hash;
+}
+
+void mesh_quantized_clean_memory(ExportableQuantizedMesh* mesh_data)
+{
+    if (mesh_data)
+    {
+        delete mesh_data;
+        mesh_data = nullptr;
+    }
+}
+
 void mesh_clean_memory(ExportableMesh* mesh_data)
 {
     if (mesh_data)
@@ -7,6 +7,11 @@ extern "C" {
     // TODO: these are custom logic methods that should probably be transfered to the provider instead
     CFBX_API void mesh_clean_memory(ExportableMesh* mesh_data);
     CFBX_API ExportableMesh* mesh_get_geometry_data(CFbxMesh* geometry);
+    CFBX_API ExportableMesh* mesh_get_geometry_data_welded(CFbxMesh* geometry, float weld_tolerance, MeshCleanupStats* stats_out);
+    CFBX_API unsigned long long mesh_get_geometry_hash(CFbxMesh* geometry);
+    CFBX_API bool mesh_get_descriptor(CFbxMesh* geometry, MeshDescriptor* descriptor_out);
+    CFBX_API void mesh_quantized_clean_memory(ExportableQuantizedMesh* mesh_data);
+    CFBX_API ExportableQuantizedMesh* mesh_get_geometry_data_quantized(CFbxMesh* geometry);
 }
 
 
@@ -0,0 +1,207 @@
+#include "mesh_cleanup.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+namespace
+{
+    typedef std::array<int64_t, 3> cell_key;
+    typedef std::array<int, 3> triangle_key;
+
+    template <typename T>
+    struct triple_hash
+    {
+        size_t operator()(const std::array<T, 3>& key) const
+        {
+            // the usual spatial hash primes, see Teschner et al. "Optimized Spatial Hashing for Collision Detection"
+            // multiply as unsigned so large cell coordinates wrap instead of overflowing
+            return (size_t)((uint64_t)key[0] * 73856093u)
+                ^ (size_t)((uint64_t)key[1] * 19349663u)
+                ^ (size_t)((uint64_t)key[2] * 83492791u);
+        }
+    };
+
+    // A tiny tolerance can push the cell coordinate outside the int64 range, and casting that is undefined.
+    // Clamp with headroom for the neighbour offsets, vertices in the clamped cell are still compared by distance.
+    int64_t get_cell_coordinate(double value)
+    {
+        const double limit = 4.0e18;
+        if (!(value > -limit)) // also catches NaN
+            return (int64_t)-limit;
+        if (value > limit)
+            return (int64_t)limit;
+        return (int64_t)std::floor(value);
+    }
+
+    cell_key get_cell(const float* position, double inverse_cell_size)
+    {
+        return {
+            get_cell_coordinate(position[0] * inverse_cell_size),
+            get_cell_coordinate(position[1] * inverse_cell_size),
+            get_cell_coordinate(position[2] * inverse_cell_size)
+        };
+    }
+
+    double get_distance_squared(const float* a, const float* b)
+    {
+        const double dx = (double)a[0] - b[0];
+        const double dy = (double)a[1] - b[1];
+        const double dz = (double)a[2] - b[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Returns a remap table from the input vertex index to the index of the vertex it was welded into.
+    // The grid cell size equals the tolerance, so any vertex within tolerance is found in the 27 neighbouring cells.
+    vector<int> weld_vertices(const vector<float>& positions, float weld_tolerance, int& welded_count)
+    {
+        const int vertex_count = (int)(positions.size() / 3);
+        vector<int> remap(vertex_count);
+        welded_count = 0;
+
+        const double inverse_cell_size = 1.0 / weld_tolerance;
+        const double tolerance_squared = (double)weld_tolerance * weld_tolerance;
+        unordered_map<cell_key, vector<int>, triple_hash<int64_t>> grid;
+        grid.reserve(vertex_count);
+
+        for (int i = 0; i < vertex_count; i++)
+        {
+            const float* position = &positions[3 * i];
+            const cell_key cell = get_cell(position, inverse_cell_size);
+
+            int match = -1;
+            for (int64_t dx = -1; dx <= 1 && match < 0; dx++)
+            for (int64_t dy = -1; dy <= 1 && match < 0; dy++)
+            for (int64_t dz = -1; dz <= 1 && match < 0; dz++)
+            {
+                const auto neighbour = grid.find({ cell[0] + dx, cell[1] + dy, cell[2] + dz });
+                if (neighbour == grid.end())
+                    continue;
+
+                for (const int candidate : neighbour->second)
+                {
+                    if (get_distance_squared(position, &positions[3 * candidate]) <= tolerance_squared)
+                    {
+                        match = candidate;
+                        break;
+                    }
+                }
+            }
+
+            if (match < 0)
+            {
+                // keep the position of the first vertex seen, averaging would let clusters drift
+                grid[cell].push_back(i);
+                remap[i] = i;
+            }
+            else
+            {
+                remap[i] = match;
+                welded_count++;
+            }
+        }
+
+        return remap;
+    }
+
+    bool is_degenerate(const vector<float>& positions, int a, int b, int c, double min_double_area)
+    {
+        if (a == b || b == c || a == c)
+            return true;
+
+        const float* pa = &positions[3 * a];
+        const float* pb = &positions[3 * b];
+        const float* pc = &positions[3 * c];
+        const double ux = (double)pb[0] - pa[0], uy = (double)pb[1] - pa[1], uz = (double)pb[2] - pa[2];
+        const double vx = (double)pc[0] - pa[0], vy = (double)pc[1] - pa[1], vz = (double)pc[2] - pa[2];
+        const double cx = uy * vz - uz * vy;
+        const double cy = uz * vx - ux * vz;
+        const double cz = ux * vy - uy * vx;
+
+        // the length of the cross product is twice the triangle area
+        return std::sqrt(cx * cx + cy * cy + cz * cz) <= min_double_area;
+    }
+
+    // Rotates the triangle so the smallest index comes first. Keeps the winding, so two back-to-back faces are
+    // not considered duplicates of each other.
+    triangle_key get_triangle_key(int a, int b, int c)
+    {
+        if (a < b && a < c)
+            return { a, b, c };
+        if (b < c)
+            return { b, c, a };
+        return { c, a, b };
+    }
+}
+
+namespace cfbx
+{
+    MeshCleanupStats weld_and_clean_mesh(
+        vector<float>& positions, vector<int>& indices, float weld_tolerance, bool is_triangle_list)
+    {
+        MeshCleanupStats stats{ 0, 0, 0, 0 };
+        const int vertex_count = (int)(positions.size() / 3);
+
+        if (weld_tolerance > 0.0f && vertex_count > 0)
+        {
+            const auto remap = weld_vertices(positions, weld_tolerance, stats.welded_vertex_count);
+            for (auto& index : indices)
+                index = remap[index];
+        }
+
+        // only triangle lists can be cleaned up, an index count divisible by 3 can just as well be quads
+        if (is_triangle_list)
+        {
+            const double min_double_area = 2.0 * (double)weld_tolerance * weld_tolerance;
+            vector<int> kept_indices;
+            kept_indices.reserve(indices.size());
+            unordered_set<triangle_key, triple_hash<int>> seen_triangles;
+            seen_triangles.reserve(indices.size() / 3);
+
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                if (is_degenerate(positions, a, b, c, weld_tolerance > 0.0f ? min_double_area : 0.0))
+                {
+                    stats.degenerate_triangle_count++;
+                    continue;
+                }
+
+                if (!seen_triangles.insert(get_triangle_key(a, b, c)).second)
+                {
+                    stats.duplicate_triangle_count++;
+                    continue;
+                }
+
+                kept_indices.insert(kept_indices.end(), { a, b, c });
+            }
+
+            indices.swap(kept_indices);
+        }
+
+        // compact the vertex list, keeping the vertices in the order they are first referenced
+        vector<int> compacted_index(vertex_count, -1);
+        vector<float> compacted_positions;
+        compacted_positions.reserve(positions.size());
+        for (auto& index : indices)
+        {
+            if (compacted_index[index] < 0)
+            {
+                compacted_index[index] = (int)(compacted_positions.size() / 3);
+                compacted_positions.insert(
+                    compacted_positions.end(),
+                    { positions[3 * index], positions[3 * index + 1], positions[3 * index + 2] });
+            }
+            index = compacted_index[index];
+        }
+
+        const int output_vertex_count = (int)(compacted_positions.size() / 3);
+        stats.unreferenced_vertex_count = vertex_count - stats.welded_vertex_count - output_vertex_count;
+        positions.swap(compacted_positions);
+
+        return stats;
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef __CFBX_MESH_CLEANUP_H__
+#define __CFBX_MESH_CLEANUP_H__
+
+#include "common.h"
+#include <vector>
+
+namespace cfbx
+{
+    // Merges vertices that are closer than weld_tolerance (in the units of positions) to each other, then removes
+    // degenerate and duplicate triangles and finally drops vertices that are no longer referenced.
+    // A weld_tolerance of zero (or less) skips the welding but still cleans up the triangles.
+    // positions is a flat xyz list, indices a list of polygon vertices. Both are modified in place.
+    // The triangle cleanup only runs if is_triangle_list is set, other polygons are only welded.
+    MeshCleanupStats weld_and_clean_mesh(
+        std::vector<float>& positions, std::vector<int>& indices, float weld_tolerance, bool is_triangle_list);
+}
+
+#endif // __CFBX_MESH_CLEANUP_H__
@@ -0,0 +1,67 @@
+#include "mesh_quantization.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace cfbx
+{
+    QuantizedPositions quantize_positions(const vector<float>& positions)
+    {
+        constexpr double max_quantized_value = numeric_limits<unsigned short>::max();
+        const size_t vertex_count = positions.size() / 3;
+
+        QuantizedPositions result;
+        result.offset = { 0.0f, 0.0f, 0.0f };
+        result.scale = { 0.0f, 0.0f, 0.0f };
+        result.max_error = 0.0f;
+        result.positions.resize(vertex_count * 3);
+
+        if (vertex_count == 0)
+            return result;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float min = positions[axis];
+            float max = positions[axis];
+            for (size_t i = 1; i < vertex_count; i++)
+            {
+                min = std::min(min, positions[3 * i + axis]);
+                max = std::max(max, positions[3 * i + axis]);
+            }
+
+            result.offset[axis] = min;
+            result.scale[axis] = (float)(((double)max - min) / max_quantized_value);
+        }
+
+        double max_error_squared = 0.0;
+        for (size_t i = 0; i < vertex_count; i++)
+        {
+            double error_squared = 0.0;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const float value = positions[3 * i + axis];
+                const float scale = result.scale[axis];
+
+                // the scale is rounded to float, so clamp in case the top of the box lands just above the last step
+                double quantized = scale > 0.0f ? std::round(((double)value - result.offset[axis]) / scale) : 0.0;
+                quantized = std::clamp(quantized, 0.0, max_quantized_value);
+                result.positions[3 * i + axis] = (unsigned short)quantized;
+
+                const float dequantized = result.offset[axis] + (float)quantized * scale;
+                const double error = (double)dequantized - value;
+                error_squared += error * error;
+            }
+            max_error_squared = std::max(max_error_squared, error_squared);
+        }
+
+        // round up, so the reported bound is never smaller than the measured error
+        const float max_error = (float)std::sqrt(max_error_squared);
+        result.max_error = (double)max_error < std::sqrt(max_error_squared)
+            ? std::nextafter(max_error, numeric_limits<float>::infinity())
+            : max_error;
+
+        return result;
+    }
+}
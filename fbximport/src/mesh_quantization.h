@@ -0,0 +1,23 @@
+#ifndef __CFBX_MESH_QUANTIZATION_H__
+#define __CFBX_MESH_QUANTIZATION_H__
+
+#include <array>
+#include <vector>
+
+namespace cfbx
+{
+    struct QuantizedPositions
+    {
+        std::vector<unsigned short> positions;
+        std::array<float, 3> offset;
+        std::array<float, 3> scale;
+        float max_error;
+    };
+
+    // Quantizes a flat xyz list to 16 bits per component relative to its axis aligned bounding box.
+    // The original position is approximated by offset + quantized * scale, and no vertex is further than
+    // max_error away from its dequantized position (evaluated in float, the way the caller will dequantize).
+    QuantizedPositions quantize_positions(const std::vector<float>& positions);
+}
+
+#endif // __CFBX_MESH_QUANTIZATION_H__
@@ -0,0 +1,212 @@
+#include "spatial.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    constexpr int sah_bin_count = 16;
+
+    struct sah_bin
+    {
+        cfbx::Aabb bounds;
+        int count = 0;
+    };
+
+    void make_leaf(cfbx::BvhBuildNode& node, int begin, int end)
+    {
+        node.first_or_right = begin;
+        node.count = end - begin;
+    }
+
+    int get_bin(float centroid, float centroid_min, float centroid_extent)
+    {
+        const int bin = (int)((centroid - centroid_min) * sah_bin_count / centroid_extent);
+        return std::clamp(bin, 0, sah_bin_count - 1);
+    }
+
+    void build_recursive(
+        const vector<cfbx::Aabb>& primitive_bounds,
+        vector<int>& indices,
+        int begin,
+        int end,
+        int max_leaf_size,
+        vector<cfbx::BvhBuildNode>& nodes)
+    {
+        // nodes may reallocate during the recursion, so only refer to this node by index
+        const int node_index = (int)nodes.size();
+        nodes.push_back({ cfbx::Aabb(), 0, 0 });
+
+        cfbx::Aabb bounds, centroid_bounds;
+        for (int i = begin; i < end; i++)
+        {
+            const auto& primitive = primitive_bounds[indices[i]];
+            bounds.extend(primitive);
+            centroid_bounds.extend(primitive.center(0), primitive.center(1), primitive.center(2));
+        }
+        nodes[node_index].bounds = bounds;
+
+        if (end - begin <= max_leaf_size)
+        {
+            make_leaf(nodes[node_index], begin, end);
+            return;
+        }
+
+        float best_cost = numeric_limits<float>::max();
+        int best_axis = -1;
+        int best_split = -1;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float centroid_extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+            if (centroid_extent <= 0.0f)
+                continue;
+
+            array<sah_bin, sah_bin_count> bins;
+            for (int i = begin; i < end; i++)
+            {
+                const auto& primitive = primitive_bounds[indices[i]];
+                auto& bin = bins[get_bin(primitive.center(axis), centroid_bounds.min[axis], centroid_extent)];
+                bin.bounds.extend(primitive);
+                bin.count++;
+            }
+
+            // sweep from the right to get the cost of everything right of each split, then from the left
+            array<float, sah_bin_count> right_cost;
+            cfbx::Aabb right_bounds;
+            int right_count = 0;
+            for (int split = sah_bin_count - 1; split > 0; split--)
+            {
+                right_bounds.extend(bins[split].bounds);
+                right_count += bins[split].count;
+                right_cost[split] = right_bounds.surface_area() * right_count;
+            }
+
+            cfbx::Aabb left_bounds;
+            int left_count = 0;
+            for (int split = 1; split < sah_bin_count; split++)
+            {
+                left_bounds.extend(bins[split - 1].bounds);
+                left_count += bins[split - 1].count;
+                if (left_count == 0 || left_count == end - begin)
+                    continue;
+
+                const float cost = left_bounds.surface_area() * left_count + right_cost[split];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = split;
+                }
+            }
+        }
+
+        int middle = begin + (end - begin) / 2;
+        if (best_axis >= 0)
+        {
+            const float centroid_min = centroid_bounds.min[best_axis];
+            const float centroid_extent = centroid_bounds.max[best_axis] - centroid_min;
+            middle = (int)(std::partition(indices.begin() + begin, indices.begin() + end, [&](int index)
+            {
+                return get_bin(primitive_bounds[index].center(best_axis), centroid_min, centroid_extent) < best_split;
+            }) - indices.begin());
+        }
+        // else all centroids coincide, any split is as good as another so split the list in half
+
+        build_recursive(primitive_bounds, indices, begin, middle, max_leaf_size, nodes);
+        nodes[node_index].first_or_right = (int)nodes.size();
+        nodes[node_index].count = 0;
+        build_recursive(primitive_bounds, indices, middle, end, max_leaf_size, nodes);
+    }
+
+    // fewer boxes than this cannot tell the model from the trash
+    constexpr size_t min_box_count_for_outliers = 5;
+
+    // quantile interpolated between the closest ranks, values must be sorted
+    float get_quantile(const vector<float>& sorted_values, double quantile)
+    {
+        const double position = quantile * (sorted_values.size() - 1);
+        const size_t lower = (size_t)position;
+        const size_t upper = std::min(lower + 1, sorted_values.size() - 1);
+        const float fraction = (float)(position - lower);
+        return sorted_values[lower] + fraction * (sorted_values[upper] - sorted_values[lower]);
+    }
+}
+
+namespace cfbx
+{
+    Bvh build_sah_bvh(const vector<Aabb>& primitive_bounds, int max_leaf_size)
+    {
+        Bvh bvh;
+        for (int i = 0; i < (int)primitive_bounds.size(); i++)
+        {
+            if (!primitive_bounds[i].is_empty())
+                bvh.primitive_indices.push_back(i);
+        }
+
+        if (bvh.primitive_indices.empty())
+            return bvh;
+
+        // a binary tree with one primitive per leaf has 2n - 1 nodes, which is the upper bound
+        bvh.nodes.reserve(2 * bvh.primitive_indices.size() - 1);
+        build_recursive(primitive_bounds, bvh.primitive_indices, 0, (int)bvh.primitive_indices.size(), std::max(max_leaf_size, 1), bvh.nodes);
+
+        return bvh;
+    }
+
+    vector<bool> find_outliers(const vector<Aabb>& bounds, float distance_factor)
+    {
+        vector<bool> outliers(bounds.size(), false);
+
+        vector<int> non_empty;
+        for (int i = 0; i < (int)bounds.size(); i++)
+        {
+            if (!bounds[i].is_empty())
+                non_empty.push_back(i);
+        }
+
+        if (distance_factor <= 0.0f || non_empty.size() < min_box_count_for_outliers)
+            return outliers;
+
+        // the interquartile range ignores up to a quarter of the boxes on either side, however few there are and
+        // however they are spread out
+        Aabb robust_extent;
+        vector<float> values(non_empty.size());
+        for (int axis = 0; axis < 3; axis++)
+        {
+            for (size_t i = 0; i < non_empty.size(); i++)
+                values[i] = bounds[non_empty[i]].center(axis);
+
+            std::sort(values.begin(), values.end());
+            robust_extent.min[axis] = get_quantile(values, 0.25);
+            robust_extent.max[axis] = get_quantile(values, 0.75);
+        }
+
+        // a model is at least as big as its typical part, this keeps tiny or flat models from flagging everything
+        for (size_t i = 0; i < non_empty.size(); i++)
+        {
+            const auto& box = bounds[non_empty[i]];
+            const float dx = box.max[0] - box.min[0], dy = box.max[1] - box.min[1], dz = box.max[2] - box.min[2];
+            values[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+        std::sort(values.begin(), values.end());
+        float size = get_quantile(values, 0.5);
+        for (int axis = 0; axis < 3; axis++)
+            size = std::max(size, robust_extent.max[axis] - robust_extent.min[axis]);
+
+        const float margin = distance_factor * size;
+        for (const int i : non_empty)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (bounds[i].max[axis] < robust_extent.min[axis] - margin || bounds[i].min[axis] > robust_extent.max[axis] + margin)
+                {
+                    outliers[i] = true;
+                    break;
+                }
+            }
+        }
+
+        return outliers;
+    }
+}
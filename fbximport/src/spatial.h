@@ -0,0 +1,70 @@
+#ifndef __CFBX_SPATIAL_H__
+#define __CFBX_SPATIAL_H__
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace cfbx
+{
+    struct Aabb
+    {
+        std::array<float, 3> min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        std::array<float, 3> max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+        bool is_empty() const { return min[0] > max[0]; }
+
+        void extend(float x, float y, float z)
+        {
+            min = { std::min(min[0], x), std::min(min[1], y), std::min(min[2], z) };
+            max = { std::max(max[0], x), std::max(max[1], y), std::max(max[2], z) };
+        }
+
+        void extend(const Aabb& other)
+        {
+            if (other.is_empty())
+                return;
+            extend(other.min[0], other.min[1], other.min[2]);
+            extend(other.max[0], other.max[1], other.max[2]);
+        }
+
+        float center(int axis) const { return 0.5f * (min[axis] + max[axis]); }
+
+        float surface_area() const
+        {
+            if (is_empty())
+                return 0.0f;
+            const float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+            return 2.0f * (dx * dy + dy * dz + dz * dx);
+        }
+    };
+
+    // Flattened BVH node. Internal nodes have count == 0, their left child is the next node in the list and
+    // first_or_right is the index of the right child. Leaves have count > 0 and cover
+    // primitive_indices[first_or_right, first_or_right + count).
+    struct BvhBuildNode
+    {
+        Aabb bounds;
+        int first_or_right;
+        int count;
+    };
+
+    struct Bvh
+    {
+        std::vector<BvhBuildNode> nodes;
+        std::vector<int> primitive_indices;
+    };
+
+    // Builds a BVH over the boxes using the surface area heuristic, evaluated on 16 centroid bins per axis.
+    // Empty boxes are left out.
+    Bvh build_sah_bvh(const std::vector<Aabb>& primitive_bounds, int max_leaf_size = 4);
+
+    // Flags the boxes that do not touch the robust extent of the set, grown by distance_factor times its size.
+    // The robust extent is the interquartile range of the box centers per axis, so parts far away from the model do
+    // not count towards it as long as they are fewer than a quarter of the boxes on each side. Sets of fewer than
+    // five boxes, or a distance_factor of zero (or less), flag nothing.
+    std::vector<bool> find_outliers(const std::vector<Aabb>& bounds, float distance_factor);
+}
+
+#endif // __CFBX_SPATIAL_H__
@@ -15,8 +15,15 @@
 #include <mesh.h>
 #include <importer.h>
 #include <manager.h>
+#include <mesh_cleanup.h>
+#include <mesh_quantization.h>
+#include <spatial.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <random>
+#include <vector>
 
 using namespace std;
 
@@ -62,3 +69,260 @@ TEST_CASE("Assert that the fbxsdk is newer or equal to a specified version", "[F
     //Test that assert_fbxsdk_version_newer_or_equal_than with (nonexisting) future version fails.
     REQUIRE(assert_fbxsdk_version_newer_or_equal_than("3020.3.2") == false);
 }
+
+TEST_CASE("Weld near-coincident vertices and remove the triangles they collapse", "[Mesh cleanup]")
+{
+    // two triangles of a quad, where the second triangle uses a copy of vertex 2 that is 1e-6 off,
+    // and a sliver triangle with two of its corners in the same near-coincident pair
+    std::vector<float> positions = {
+        0.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f,
+        1.0f, 1.0f, 0.0f,
+        1.0f, 1.000001f, 0.0f,
+        0.0f, 1.0f, 0.0f,
+        5.0f, 5.0f, 5.0f, // unreferenced
+    };
+    std::vector<int> indices = {
+        0, 1, 2,
+        0, 3, 4,
+        1, 2, 3,
+        0, 1, 2, // exact duplicate
+    };
+
+    const auto stats = cfbx::weld_and_clean_mesh(positions, indices, 1e-5f, true);
+
+    REQUIRE(stats.welded_vertex_count == 1);
+    REQUIRE(stats.unreferenced_vertex_count == 1);
+    REQUIRE(stats.degenerate_triangle_count == 1);
+    REQUIRE(stats.duplicate_triangle_count == 1);
+    REQUIRE(positions.size() == 4 * 3);
+    REQUIRE(indices == std::vector<int>{ 0, 1, 2, 0, 2, 3 });
+}
+
+TEST_CASE("Mesh cleanup without tolerance keeps near-coincident vertices", "[Mesh cleanup]")
+{
+    std::vector<float> positions = {
+        0.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f,
+        1.0f, 1.0f, 0.0f,
+        1.0f, 1.000001f, 0.0f,
+    };
+    std::vector<int> indices = { 0, 1, 2, 0, 1, 3, 0, 0, 1 };
+
+    const auto stats = cfbx::weld_and_clean_mesh(positions, indices, 0.0f, true);
+
+    REQUIRE(stats.welded_vertex_count == 0);
+    REQUIRE(stats.degenerate_triangle_count == 1);
+    REQUIRE(stats.duplicate_triangle_count == 0);
+    REQUIRE(positions.size() == 4 * 3);
+    REQUIRE(indices.size() == 6);
+}
+
+TEST_CASE("Welding with a tiny tolerance far from the origin", "[Mesh cleanup]")
+{
+    // the cell coordinates of these vertices are far outside the int64 range
+    std::vector<float> positions = {
+        1e10f, 0.0f, 0.0f,
+        1e10f, 1.0f, 0.0f,
+        -1e10f, 0.0f, 1.0f,
+        1e10f, 0.0f, 0.0f, // exact copy of vertex 0
+    };
+    std::vector<int> indices = { 0, 1, 2, 3, 2, 1 };
+
+    const auto stats = cfbx::weld_and_clean_mesh(positions, indices, 1e-30f, true);
+
+    REQUIRE(stats.welded_vertex_count == 1);
+    REQUIRE(positions.size() == 3 * 3);
+    REQUIRE(indices.size() == 6);
+}
+
+TEST_CASE("Quads are welded but not cleaned up as triangles", "[Mesh cleanup]")
+{
+    // three quads, 12 indices, where reading them as triangles would find "degenerate" and "duplicate" ones
+    std::vector<float> positions = {
+        0.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f,
+        1.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 0.0f,
+        0.0f, 1.000001f, 0.0f,
+    };
+    std::vector<int> indices = {
+        0, 1, 2, 3,
+        0, 0, 1, 2,
+        3, 4, 1, 0,
+    };
+
+    const auto stats = cfbx::weld_and_clean_mesh(positions, indices, 1e-5f, false);
+
+    REQUIRE(stats.welded_vertex_count == 1);
+    REQUIRE(stats.degenerate_triangle_count == 0);
+    REQUIRE(stats.duplicate_triangle_count == 0);
+    REQUIRE(positions.size() == 4 * 3);
+    REQUIRE(indices == std::vector<int>{ 0, 1, 2, 3, 0, 0, 1, 2, 3, 3, 1, 0 });
+}
+
+TEST_CASE("Quantized positions stay within the reported error bound", "[Mesh quantization]")
+{
+    // a 6m scaffold part placed far from the origin, where float precision is already coarse
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> distribution(0.0f, 6.0f);
+    std::vector<float> positions;
+    for (int i = 0; i < 10000; i++)
+    {
+        positions.push_back(1500.0f + distribution(generator));
+        positions.push_back(-800.0f + distribution(generator) * 0.1f);
+        positions.push_back(40.0f + distribution(generator) * 0.5f);
+    }
+
+    const auto quantized = cfbx::quantize_positions(positions);
+
+    REQUIRE(quantized.positions.size() == positions.size());
+
+    // rounding to the nearest step is off by at most half a step per axis
+    const double half_step_diagonal = 0.5 * std::sqrt(
+        (double)quantized.scale[0] * quantized.scale[0] +
+        (double)quantized.scale[1] * quantized.scale[1] +
+        (double)quantized.scale[2] * quantized.scale[2]);
+    REQUIRE(quantized.max_error > 0.0f);
+    REQUIRE(quantized.max_error < 2.0 * half_step_diagonal);
+
+    for (size_t i = 0; i < positions.size(); i += 3)
+    {
+        double error_squared = 0.0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float dequantized = quantized.offset[axis] + (float)quantized.positions[i + axis] * quantized.scale[axis];
+            const double error = (double)dequantized - positions[i + axis];
+            error_squared += error * error;
+        }
+        REQUIRE(std::sqrt(error_squared) <= quantized.max_error);
+    }
+}
+
+TEST_CASE("Quantizing a flat mesh keeps the flat axis exact", "[Mesh quantization]")
+{
+    std::vector<float> positions = { 0.0f, 0.0f, 2.0f, 1.0f, 0.0f, 2.0f, 1.0f, 1.0f, 2.0f };
+
+    const auto quantized = cfbx::quantize_positions(positions);
+
+    REQUIRE(quantized.scale[2] == 0.0f);
+    REQUIRE(quantized.offset[2] == 2.0f);
+    REQUIRE(quantized.positions[0] == 0);
+    REQUIRE(quantized.positions[3] == 65535);
+    REQUIRE(quantized.max_error == 0.0f);
+}
+
+static cfbx::Aabb create_box(float x, float y, float z, float size)
+{
+    cfbx::Aabb box;
+    box.extend(x, y, z);
+    box.extend(x + size, y + size, z + size);
+    return box;
+}
+
+static bool contains(const cfbx::Aabb& outer, const cfbx::Aabb& inner)
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (inner.min[axis] < outer.min[axis] || inner.max[axis] > outer.max[axis])
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("SAH BVH covers every non-empty box exactly once", "[Spatial]")
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(0.0f, 100.0f);
+    std::vector<cfbx::Aabb> boxes;
+    for (int i = 0; i < 500; i++)
+    {
+        boxes.push_back(create_box(distribution(generator), distribution(generator), distribution(generator), 1.0f));
+    }
+    boxes.push_back(cfbx::Aabb()); // nodes without geometry have empty bounds
+
+    const auto bvh = cfbx::build_sah_bvh(boxes);
+
+    REQUIRE(bvh.primitive_indices.size() == 500);
+    REQUIRE(bvh.nodes.size() < 2 * bvh.primitive_indices.size());
+
+    std::vector<int> seen(boxes.size(), 0);
+    for (size_t i = 0; i < bvh.nodes.size(); i++)
+    {
+        const auto& node = bvh.nodes[i];
+        if (node.count > 0)
+        {
+            REQUIRE(node.count <= 4);
+            for (int p = node.first_or_right; p < node.first_or_right + node.count; p++)
+            {
+                const int box = bvh.primitive_indices[p];
+                REQUIRE(contains(node.bounds, boxes[box]));
+                seen[box]++;
+            }
+        }
+        else
+        {
+            REQUIRE(contains(node.bounds, bvh.nodes[i + 1].bounds));
+            REQUIRE(contains(node.bounds, bvh.nodes[node.first_or_right].bounds));
+        }
+    }
+
+    REQUIRE(std::count(seen.begin(), seen.end(), 1) == 500);
+    REQUIRE(seen.back() == 0);
+}
+
+TEST_CASE("Boxes far away from the model are outliers", "[Spatial]")
+{
+    std::vector<cfbx::Aabb> boxes;
+    for (int i = 0; i < 50; i++)
+    {
+        boxes.push_back(create_box((float)(i % 10), (float)(i / 10), 0.0f, 0.5f));
+    }
+    boxes.push_back(create_box(12.0f, 3.0f, 0.0f, 0.5f)); // close to the model
+    boxes.push_back(create_box(5000.0f, 0.0f, 0.0f, 0.5f)); // trash
+
+    const auto outliers = cfbx::find_outliers(boxes, 2.0f);
+
+    REQUIRE(std::count(outliers.begin(), outliers.end(), true) == 1);
+    REQUIRE(outliers.back());
+
+    const auto disabled = cfbx::find_outliers(boxes, 0.0f);
+    REQUIRE(std::count(disabled.begin(), disabled.end(), true) == 0);
+}
+
+TEST_CASE("A single outlier is found in a small model", "[Spatial]")
+{
+    std::vector<cfbx::Aabb> boxes;
+    for (int i = 0; i < 9; i++)
+    {
+        boxes.push_back(create_box((float)i, 0.0f, 0.0f, 1.0f));
+    }
+    boxes.push_back(create_box(5000.0f, 0.0f, 0.0f, 1.0f));
+
+    const auto outliers = cfbx::find_outliers(boxes, 2.0f);
+
+    REQUIRE(std::count(outliers.begin(), outliers.end(), true) == 1);
+    REQUIRE(outliers.back());
+
+    // too few boxes to tell the model from the trash
+    const std::vector<cfbx::Aabb> too_few(boxes.end() - 4, boxes.end());
+    const auto too_few_outliers = cfbx::find_outliers(too_few, 2.0f);
+    REQUIRE(std::count(too_few_outliers.begin(), too_few_outliers.end(), true) == 0);
+}
+
+TEST_CASE("Clustered outliers on both sides of the model are found", "[Spatial]")
+{
+    std::vector<cfbx::Aabb> boxes;
+    for (int i = 0; i < 20; i++)
+    {
+        boxes.push_back(create_box((float)i, 0.0f, 0.0f, 1.0f));
+    }
+    boxes.push_back(create_box(5000.0f, 0.0f, 0.0f, 1.0f));
+    boxes.push_back(create_box(6000.0f, 0.0f, 0.0f, 1.0f));
+    boxes.push_back(create_box(-5000.0f, 0.0f, 0.0f, 1.0f));
+
+    const auto outliers = cfbx::find_outliers(boxes, 2.0f);
+
+    REQUIRE(std::count(outliers.begin(), outliers.end(), true) == 3);
+    REQUIRE(std::none_of(outliers.begin(), outliers.begin() + 20, [](bool outlier) { return outlier; }));
+}